@@ -1,8 +1,16 @@
 #include <benchmark/benchmark.h>
 #include "FSMgine/FSM.hpp"
 #include "FSMgine/FSMBuilder.hpp"
+#include "FSMgine/CompiledFSM.hpp"
+#include "FSMgine/FSMRuntime.hpp"
+#include "FSMgine/StaticFSM.hpp"
 #include "FSMgine/StringInterner.hpp"
+#include <atomic>
+#include <memory_resource>
+#include <string>
+#include <thread>
 #include <variant>
+#include <vector>
 
 using namespace fsmgine;
 
@@ -109,6 +117,25 @@ static void BM_FSM_OptimizedStateLookups(benchmark::State& state) {
 }
 BENCHMARK(BM_FSM_OptimizedStateLookups);
 
+// Threads building machines at once all intern state names; each thread uses its own
+static void BM_StringInterner_ConcurrentIntern(benchmark::State& state) {
+    std::vector<std::string> names;
+    for (int i = 0; i < 64; ++i) {
+        names.push_back("tenant" + std::to_string(state.thread_index()) + "_state" + std::to_string(i));
+    }
+    auto& interner = StringInterner::instance();
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(interner.intern(std::string_view(names[i++ % names.size()])));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+#ifdef FSMGINE_MULTI_THREADED
+BENCHMARK(BM_StringInterner_ConcurrentIntern)->ThreadRange(1, 32)->UseRealTime();
+#else
+BENCHMARK(BM_StringInterner_ConcurrentIntern); // The single-threaded interner takes no lock
+#endif
+
 // Benchmark event object creation
 static void BM_FSM_EventCreation_Current(benchmark::State& state) {
     for (auto _ : state) {
@@ -130,11 +157,8 @@ static void BM_FSM_EventCreation_Static(benchmark::State& state) {
 }
 BENCHMARK(BM_FSM_EventCreation_Static);
 
-// Comprehensive FSM benchmark with realistic workload
-static void BM_FSM_RealisticWorkload(benchmark::State& state) {
-    FSM<TestEvent> fsm;
-    
-    // Create a more complex FSM
+// Builds the workflow-like FSM shared by the realistic workload benchmarks
+static void buildWorkflowFSM(FSM<TestEvent>& fsm) {
     auto builder = fsm.get_builder();
     
     // Build a workflow-like FSM with transitions
@@ -169,7 +193,12 @@ static void BM_FSM_RealisticWorkload(benchmark::State& state) {
     builder.from("retrying")
         .predicate([](const TestEvent& e) { return e.value == -2; })
         .to("failed");
-    
+}
+
+// Comprehensive FSM benchmark with realistic workload
+static void BM_FSM_RealisticWorkload(benchmark::State& state) {
+    FSM<TestEvent> fsm;
+    buildWorkflowFSM(fsm);
     fsm.setInitialState("idle");
     
     // Simulate realistic event sequence
@@ -186,4 +215,716 @@ static void BM_FSM_RealisticWorkload(benchmark::State& state) {
         benchmark::DoNotOptimize(fsm.getCurrentState());
     }
 }
-BENCHMARK(BM_FSM_RealisticWorkload); 
\ No newline at end of file
+BENCHMARK(BM_FSM_RealisticWorkload);
+
+// Same workload on the compiled, integer-indexed machine
+static void BM_CompiledFSM_RealisticWorkload(benchmark::State& state) {
+    FSM<TestEvent> fsm;
+    buildWorkflowFSM(fsm);
+    auto compiled = fsm.compile();
+    compiled.setInitialState("idle");
+    
+    std::vector<int> event_sequence = {1, 2, 3}; // idle->validating->processing->completed
+    
+    for (auto _ : state) {
+        compiled.setCurrentState("idle");
+        
+        for (int val : event_sequence) {
+            TestEvent event{val, "test_data"};
+            compiled.process(event);
+        }
+        
+        benchmark::DoNotOptimize(compiled.getCurrentStateId());
+    }
+}
+BENCHMARK(BM_CompiledFSM_RealisticWorkload);
+
+// Many sessions of one workflow, each counting its own steps: capturing lambdas need a
+// definition per session, a context-mode definition is shared by every session
+static constexpr int SESSIONS = 64;
+
+struct SessionStats {
+    int steps = 0;
+    void step(const TestEvent&) { steps++; }
+};
+
+template<typename TBuilder, typename TGuard, typename TAction>
+static void buildCountingWorkflow(TBuilder&& builder, TGuard is, TAction count) {
+    const int edges[][3] = {{0, 1, 1}, {1, 2, 2}, {2, 3, 3}, {2, 0, 0}, {3, 0, 0}}; // from, value, to
+    const char* names[] = {"idle", "validating", "processing", "completed"};
+    for (const auto& [from, value, to] : edges) {
+        builder.from(names[from]).predicate(is(value)).action(count).to(names[to]);
+    }
+}
+
+static void BM_CompiledFSM_SessionsCapturing(benchmark::State& state) {
+    std::vector<SessionStats> stats(SESSIONS);
+    std::vector<CompiledFSM<TestEvent>> sessions;
+    for (auto& session_stats : stats) {
+        FSM<TestEvent> fsm;
+        buildCountingWorkflow(fsm.get_builder(),
+            [](int value) { return [value](const TestEvent& e) { return e.value == value; }; },
+            [&session_stats](const TestEvent& e) { session_stats.step(e); });
+        sessions.push_back(fsm.compile());
+        sessions.back().setInitialState("idle");
+    }
+
+    const TestEvent events[] = {{1, ""}, {2, ""}, {0, ""}};
+    for (auto _ : state) {
+        for (auto& session : sessions) {
+            for (const auto& event : events) {
+                session.process(event);
+            }
+        }
+    }
+    benchmark::DoNotOptimize(stats.front().steps);
+    state.SetItemsProcessed(state.iterations() * SESSIONS * 3);
+}
+BENCHMARK(BM_CompiledFSM_SessionsCapturing);
+
+template<int N>
+static bool contextValueIs(SessionStats&, const TestEvent& e) {
+    return e.value == N;
+}
+
+static void BM_CompiledFSM_SessionsContext(benchmark::State& state) {
+    using ContextGuard = FSM<TestEvent, std::string_view, SessionStats>::Predicate;
+    FSM<TestEvent, std::string_view, SessionStats> blueprint;
+    const ContextGuard guards[] = {&contextValueIs<0>, &contextValueIs<1>, &contextValueIs<2>, &contextValueIs<3>};
+    buildCountingWorkflow(blueprint.get_builder(),
+        [&guards](int value) { return guards[value]; },
+        memberFn<&SessionStats::step>);
+    auto definition = blueprint.compileDefinition();
+
+    std::vector<SessionStats> stats(SESSIONS);
+    std::vector<FSMInstance<TestEvent, SessionStats>> sessions;
+    for (auto& session_stats : stats) {
+        sessions.emplace_back(definition, session_stats);
+        sessions.back().setInitialState("idle");
+    }
+
+    const TestEvent events[] = {{1, ""}, {2, ""}, {0, ""}};
+    for (auto _ : state) {
+        for (auto& session : sessions) {
+            for (const auto& event : events) {
+                session.process(event);
+            }
+        }
+    }
+    benchmark::DoNotOptimize(stats.front().steps);
+    state.SetItemsProcessed(state.iterations() * SESSIONS * 3);
+}
+BENCHMARK(BM_CompiledFSM_SessionsContext);
+
+// Same workload with the topology fixed at compile time
+enum class Workflow { IDLE, VALIDATING, PROCESSING, COMPLETED, REJECTED, RETRYING, FAILED, ERROR };
+
+template<int N>
+struct ValueIs {
+    bool operator()(const TestEvent& e) const { return e.value == N; }
+};
+
+struct ValueNegative {
+    bool operator()(const TestEvent& e) const { return e.value < 0; }
+};
+
+namespace workflow {
+using namespace static_fsm;
+using Machine = StaticFSM<Workflow, TestEvent,
+    from<Workflow::IDLE>::predicate<ValueIs<1>>::to<Workflow::VALIDATING>,
+    from<Workflow::IDLE>::predicate<ValueNegative>::to<Workflow::ERROR>,
+    from<Workflow::VALIDATING>::predicate<ValueIs<2>>::to<Workflow::PROCESSING>,
+    from<Workflow::VALIDATING>::predicate<ValueIs<0>>::to<Workflow::REJECTED>,
+    from<Workflow::PROCESSING>::predicate<ValueIs<3>>::to<Workflow::COMPLETED>,
+    from<Workflow::PROCESSING>::predicate<ValueIs<-1>>::to<Workflow::RETRYING>,
+    from<Workflow::RETRYING>::predicate<ValueIs<2>>::to<Workflow::PROCESSING>,
+    from<Workflow::RETRYING>::predicate<ValueIs<-2>>::to<Workflow::FAILED>>;
+} // namespace workflow
+
+static void BM_StaticFSM_RealisticWorkload(benchmark::State& state) {
+    workflow::Machine machine;
+    machine.setInitialState(Workflow::IDLE);
+    
+    std::vector<int> event_sequence = {1, 2, 3}; // idle->validating->processing->completed
+    
+    for (auto _ : state) {
+        machine.setCurrentState(Workflow::IDLE);
+        
+        for (int val : event_sequence) {
+            TestEvent event{val, "test_data"};
+            machine.process(event);
+        }
+        
+        benchmark::DoNotOptimize(machine.getCurrentState());
+    }
+}
+BENCHMARK(BM_StaticFSM_RealisticWorkload);
+
+// Dispatch in a state with many outgoing transitions: predicate scan vs keyed jump table
+static constexpr int FAN_OUT = 40;
+
+static void BM_CompiledFSM_FanOutPredicates(benchmark::State& state) {
+    FSM<int> fsm;
+    for (int i = 0; i < FAN_OUT; ++i) {
+        fsm.get_builder().from("hub")
+            .predicate([i](const int& e) { return e == i; })
+            .to("hub");
+    }
+    auto compiled = fsm.compile();
+    compiled.setInitialState("hub");
+    
+    int event = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(compiled.process(event));
+        event = (event + 7) % (FAN_OUT + 1); // Includes one miss
+    }
+}
+BENCHMARK(BM_CompiledFSM_FanOutPredicates);
+
+static void BM_CompiledFSM_FanOutKeyed(benchmark::State& state) {
+    FSM<int> fsm;
+    for (int i = 0; i < FAN_OUT; ++i) {
+        fsm.get_builder().from("hub").on(i).to("hub");
+    }
+    auto compiled = fsm.compile();
+    compiled.setInitialState("hub");
+    
+    int event = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(compiled.process(event));
+        event = (event + 7) % (FAN_OUT + 1); // Includes one miss
+    }
+}
+BENCHMARK(BM_CompiledFSM_FanOutKeyed);
+
+// Variant events: guards testing holds_alternative vs transitions keyed by alternative
+struct NetConnect { int id; };
+struct NetData { int size; };
+struct NetClose { int code; };
+struct NetTimeout { int ms; };
+using NetEvent = std::variant<NetConnect, NetData, NetClose, NetTimeout>;
+static constexpr int VARIANT_CASES = 6; // Guarded transitions per alternative
+
+static void runVariantEvents(benchmark::State& state, CompiledFSM<NetEvent>& compiled) {
+    const NetEvent events[] = {NetData{5}, NetTimeout{3}, NetConnect{1}, NetClose{5}, NetData{9}};
+    std::size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(compiled.process(events[next]));
+        next = (next + 1) % std::size(events);
+    }
+}
+
+static void BM_CompiledFSM_VariantHoldsAlternative(benchmark::State& state) {
+    FSM<NetEvent> fsm;
+    for (int i = 0; i < VARIANT_CASES; ++i) {
+        auto builder = fsm.get_builder();
+        builder.from("open").predicate([i](const NetEvent& e) {
+            return std::holds_alternative<NetConnect>(e) && std::get<NetConnect>(e).id == i; }).to("open");
+        builder.from("open").predicate([i](const NetEvent& e) {
+            return std::holds_alternative<NetData>(e) && std::get<NetData>(e).size == i; }).to("open");
+        builder.from("open").predicate([i](const NetEvent& e) {
+            return std::holds_alternative<NetClose>(e) && std::get<NetClose>(e).code == i; }).to("open");
+        builder.from("open").predicate([i](const NetEvent& e) {
+            return std::holds_alternative<NetTimeout>(e) && std::get<NetTimeout>(e).ms == i; }).to("open");
+    }
+    auto compiled = fsm.compile();
+    compiled.setInitialState("open");
+    runVariantEvents(state, compiled);
+}
+BENCHMARK(BM_CompiledFSM_VariantHoldsAlternative);
+
+static void BM_CompiledFSM_VariantKeyed(benchmark::State& state) {
+    FSM<NetEvent> fsm;
+    for (int i = 0; i < VARIANT_CASES; ++i) {
+        auto builder = fsm.get_builder();
+        builder.from("open").on<NetConnect>().predicate([i](const NetConnect& c) { return c.id == i; }).to("open");
+        builder.from("open").on<NetData>().predicate([i](const NetData& d) { return d.size == i; }).to("open");
+        builder.from("open").on<NetClose>().predicate([i](const NetClose& c) { return c.code == i; }).to("open");
+        builder.from("open").on<NetTimeout>().predicate([i](const NetTimeout& t) { return t.ms == i; }).to("open");
+    }
+    auto compiled = fsm.compile();
+    compiled.setInitialState("open");
+    runVariantEvents(state, compiled);
+}
+BENCHMARK(BM_CompiledFSM_VariantKeyed);
+
+// Building a large machine: many states, each with several guarded transitions whose
+// captures are too big for std::function's small-buffer storage
+static constexpr int BUILD_STATES = 500;
+
+static void buildLargeMachine(FSM<int>& fsm) {
+    auto builder = fsm.get_builder();
+    for (int i = 0; i < BUILD_STATES; ++i) {
+        const std::string from = "S" + std::to_string(i);
+        for (int j = 1; j <= 4; ++j) {
+            long low = i * 10 + j;
+            long high = low + 5;
+            long step = j;
+            builder.from(from)
+                .predicate([low, high, step](const int& e) { return e >= low && e < high && e % step == 0; })
+                .action([low, high, step](const int& e) { benchmark::DoNotOptimize(e + low + high + step); })
+                .to("S" + std::to_string((i + j) % BUILD_STATES));
+        }
+    }
+}
+
+static void BM_FSM_BuildLargeMachine(benchmark::State& state) {
+    for (auto _ : state) {
+        FSM<int> fsm;
+        buildLargeMachine(fsm);
+        benchmark::DoNotOptimize(fsm);
+    }
+    state.SetItemsProcessed(state.iterations() * BUILD_STATES * 4);
+}
+BENCHMARK(BM_FSM_BuildLargeMachine);
+
+// Same machine with all topology storage carved from one reused arena
+static void BM_FSM_BuildLargeMachineArena(benchmark::State& state) {
+    std::vector<std::byte> buffer(8 * 1024 * 1024);
+    for (auto _ : state) {
+        std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+        FSM<int> fsm(&arena);
+        buildLargeMachine(fsm);
+        benchmark::DoNotOptimize(fsm);
+    }
+    state.SetItemsProcessed(state.iterations() * BUILD_STATES * 4);
+}
+BENCHMARK(BM_FSM_BuildLargeMachineArena);
+
+// Draining a queue of events into one FSM: one process() call per event vs one batch
+static void buildQueueDrainFSM(FSM<int>& fsm) {
+    fsm.get_builder().from("idle").on(1).to("busy");
+    fsm.get_builder().from("busy").on(0).to("idle");
+    fsm.get_builder().from("busy").on(2).to("busy");
+}
+
+static std::vector<int> makeEventQueue() {
+    std::vector<int> events;
+    events.reserve(10000);
+    for (int i = 0; i < 10000; ++i) {
+        events.push_back(i % 4 == 3 ? 0 : (i % 4 == 0 ? 1 : 2));
+    }
+    return events;
+}
+
+static void BM_FSM_QueueDrainSingle(benchmark::State& state) {
+    FSM<int> fsm;
+    buildQueueDrainFSM(fsm);
+    fsm.setInitialState("idle");
+    const auto events = makeEventQueue();
+    
+    for (auto _ : state) {
+        for (int e : events) {
+            benchmark::DoNotOptimize(fsm.process(e));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * events.size()));
+}
+BENCHMARK(BM_FSM_QueueDrainSingle);
+
+// Same queue on a machine with enum states: array lookups instead of hashing names
+enum class DrainState { IDLE, BUSY, COUNT };
+
+static void BM_FSM_QueueDrainEnumStates(benchmark::State& state) {
+    FSM<int, DrainState> fsm;
+    fsm.get_builder().from(DrainState::IDLE).on(1).to(DrainState::BUSY);
+    fsm.get_builder().from(DrainState::BUSY).on(0).to(DrainState::IDLE);
+    fsm.get_builder().from(DrainState::BUSY).on(2).to(DrainState::BUSY);
+    fsm.setInitialState(DrainState::IDLE);
+    const auto events = makeEventQueue();
+    
+    for (auto _ : state) {
+        for (int e : events) {
+            benchmark::DoNotOptimize(fsm.process(e));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * events.size()));
+}
+BENCHMARK(BM_FSM_QueueDrainEnumStates);
+
+static void BM_FSM_QueueDrainBatch(benchmark::State& state) {
+    FSM<int> fsm;
+    buildQueueDrainFSM(fsm);
+    fsm.setInitialState("idle");
+    const auto events = makeEventQueue();
+    
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fsm.processBatch(events.begin(), events.end()));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * events.size()));
+}
+BENCHMARK(BM_FSM_QueueDrainBatch);
+
+// An action that raises a follow-up event for its own machine, processed before
+// process() returns; each iteration takes two transitions
+static void BM_FSM_PostInternal(benchmark::State& state) {
+    FSM<int> fsm;
+    fsm.get_builder().from("idle").on(1).action([&fsm](const int&) { fsm.postInternal(0); }).to("busy");
+    fsm.get_builder().from("busy").on(0).to("idle");
+    fsm.setInitialState("idle");
+    
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fsm.process(1));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_FSM_PostInternal);
+
+// Many threads feeding one machine whose action does some work: calling process()
+// serializes every producer on the action, post() hands the event to one consumer
+static void slowAction(const int& e) {
+    int work = e;
+    for (int i = 0; i < 64; ++i) {
+        benchmark::DoNotOptimize(work += i);
+    }
+}
+
+#ifdef FSMGINE_MULTI_THREADED
+static FSM<int>& sharedWorkFSM() {
+    static FSM<int> fsm = [] {
+        FSM<int> machine;
+        machine.get_builder().from("working").action(slowAction).to("working");
+        machine.setInitialState("working");
+        return machine;
+    }();
+    return fsm;
+}
+
+static void BM_FSM_SharedProcess(benchmark::State& state) {
+    auto& fsm = sharedWorkFSM();
+    for (auto _ : state) {
+        fsm.process(1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FSM_SharedProcess)->ThreadRange(1, 8)->UseRealTime();
+#endif
+
+#ifdef FSMGINE_MULTI_THREADED
+// Same machine with ActionTiming::AfterCommit: the lock covers only the guard scan and
+// the commit, while the actions still run one at a time in commit order
+static FSM<int>& sharedAfterCommitFSM() {
+    static FSM<int> fsm = [] {
+        FSM<int> machine;
+        machine.get_builder().from("working").action(slowAction).to("working");
+        machine.setActionTiming(ActionTiming::AfterCommit);
+        machine.setInitialState("working");
+        return machine;
+    }();
+    return fsm;
+}
+
+static void BM_FSM_SharedProcessAfterCommit(benchmark::State& state) {
+    auto& fsm = sharedAfterCommitFSM();
+    for (auto _ : state) {
+        fsm.process(1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FSM_SharedProcessAfterCommit)->ThreadRange(1, 8)->UseRealTime();
+#endif
+
+#ifdef FSMGINE_MULTI_THREADED
+// Many threads sending cheap events to one machine, where handing the lock over costs
+// more than processing: plain locking vs flat combining
+template<typename Machine>
+static void buildContendedFSM(Machine& machine) {
+    static std::atomic<long long> total{0};
+    machine.get_builder()
+        .from("open")
+        .predicate([](const int& e) { return e > 0; })
+        .action([](const int& e) { total.fetch_add(e, std::memory_order_relaxed); })
+        .to("open");
+    machine.setInitialState("open");
+}
+
+static void BM_FSM_ContendedProcess(benchmark::State& state) {
+    static FSM<int> fsm = [] {
+        FSM<int> machine;
+        buildContendedFSM(machine);
+        return machine;
+    }();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fsm.process(1));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FSM_ContendedProcess)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_FSM_ContendedProcessCombining(benchmark::State& state) {
+    static FSM<int> fsm = [] {
+        FSM<int> machine;
+        buildContendedFSM(machine);
+        machine.setFlatCombining(true);
+        return machine;
+    }();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fsm.process(1));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FSM_ContendedProcessCombining)->ThreadRange(1, 16)->UseRealTime();
+#endif
+
+#ifdef FSMGINE_MULTI_THREADED
+// Lock policies other than NoLock are only available in FSMgineMT
+
+// The same contended machine behind a spin lock instead of the default mutex
+static void BM_FSM_ContendedProcessSpinLock(benchmark::State& state) {
+    static FSM<int, std::string_view, void, SpinLock> fsm = [] {
+        FSM<int, std::string_view, void, SpinLock> machine;
+        buildContendedFSM(machine);
+        return machine;
+    }();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fsm.process(1));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FSM_ContendedProcessSpinLock)->ThreadRange(1, 16)->UseRealTime();
+
+// A machine only one thread drives pays nothing for locking
+static void BM_FSM_ProcessNoLock(benchmark::State& state) {
+    FSM<int, std::string_view, void, NoLock> fsm;
+    buildContendedFSM(fsm);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fsm.process(1));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FSM_ProcessNoLock);
+#endif
+
+#ifdef FSMGINE_MULTI_THREADED
+static void BM_FSM_SharedPost(benchmark::State& state) {
+    auto& fsm = sharedWorkFSM();
+    static std::atomic<bool> stop{false};
+    static std::thread consumer;
+    if (state.thread_index() == 0) {
+        stop = false;
+        consumer = std::thread([&fsm] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (fsm.drain().transitions == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto _ : state) {
+        while (!fsm.post(1)) {
+            std::this_thread::yield();
+        }
+    }
+    if (state.thread_index() == 0) {
+        stop = true;
+        consumer.join();
+        fsm.drain();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FSM_SharedPost)->ThreadRange(1, 8)->UseRealTime();
+#endif
+
+// Many independent machines driven by an FSMRuntime; the argument is the worker count.
+// One thread posts round-robin to 10000 instances, so each worker runs batches of events
+// for the instances it has picked up.
+static void BM_FSMRuntime_ManyInstances(benchmark::State& state) {
+    FSM<int> blueprint;
+    blueprint.get_builder().from("working").action(slowAction).to("working");
+    auto definition = blueprint.compileDefinition();
+
+    FSMRuntime<int> runtime(static_cast<std::size_t>(state.range(0)));
+    std::vector<FSMRuntime<int>::Handle> handles;
+    for (int i = 0; i < 10000; ++i) {
+        FSMInstance<int> instance(definition);
+        instance.setInitialState("working");
+        handles.push_back(runtime.spawn(std::move(instance)));
+    }
+
+    std::size_t next = 0;
+    for (auto _ : state) {
+        while (!runtime.post(handles[next], 1)) {
+            std::this_thread::yield();
+        }
+        next = next + 1 == handles.size() ? 0 : next + 1;
+    }
+    runtime.waitIdle();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FSMRuntime_ManyInstances)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+// Reader scaling: many threads polling getCurrentState() on one shared FSM. In the
+// FSMgineMT build readers take no lock, so throughput should grow with the thread count.
+static FSM<>& sharedPolledFSM() {
+    static FSM<> fsm = [] {
+        FSM<> polled;
+        polled.get_builder().from("A").to("B");
+        polled.get_builder().from("B").to("A");
+        polled.setInitialState("A");
+        return polled;
+    }();
+    return fsm;
+}
+
+static void BM_FSM_ConcurrentReaders(benchmark::State& state) {
+    auto& fsm = sharedPolledFSM();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fsm.getCurrentState());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FSM_ConcurrentReaders)->ThreadRange(1, 8)->UseRealTime();
+
+#ifdef FSMGINE_MULTI_THREADED
+// One thread processing events while the others poll; readers must not slow the writer
+static void BM_FSM_ReadersWithWriter(benchmark::State& state) {
+    auto& fsm = sharedPolledFSM();
+    const bool writer = state.thread_index() == 0;
+    for (auto _ : state) {
+        if (writer) {
+            benchmark::DoNotOptimize(fsm.process());
+        } else {
+            benchmark::DoNotOptimize(fsm.getCurrentState());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FSM_ReadersWithWriter)->ThreadRange(2, 8)->UseRealTime();
+#endif
+
+#ifdef FSMGINE_MULTI_THREADED
+// Event processing while another thread keeps publishing edits. Edits build a new table
+// and swap it in, so the processing thread should not slow down as editors are added.
+static FSM<int>& sharedEditedFSM() {
+    static FSM<int> fsm = [] {
+        FSM<int> edited;
+        buildQueueDrainFSM(edited);
+        edited.setInitialState("idle");
+        return edited;
+    }();
+    return fsm;
+}
+
+static void BM_FSM_ProcessDuringLiveEdits(benchmark::State& state) {
+    auto& fsm = sharedEditedFSM();
+    const bool processor = state.thread_index() == 0;
+    int event = 0;
+    for (auto _ : state) {
+        if (processor) {
+            benchmark::DoNotOptimize(fsm.process(event));
+            event = (event + 1) % 3;
+        } else {
+            fsm.get_builder().keyedBy([](const int& e) { return e; });
+        }
+    }
+    if (processor) {
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+BENCHMARK(BM_FSM_ProcessDuringLiveEdits)->Threads(1)->Threads(2)->UseRealTime();
+#endif
+
+// Byte-driven parsing: a COMMAND:KEY=value;...; wire format, one process() per byte
+static void buildCommandParser(FSM<char>& fsm, std::size_t& value_bytes, bool span_actions = false) {
+    auto builder = fsm.get_builder();
+    builder.from("START").onChars("a-zA-Z").to("COMMAND");
+    builder.from("COMMAND").onChars("a-zA-Z0-9").to("COMMAND");
+    builder.from("COMMAND").onChars(":").to("PARAM_NAME");
+    builder.from("PARAM_NAME").onChars("a-zA-Z0-9").to("PARAM_NAME");
+    builder.from("PARAM_NAME").onChars("=").to("PARAM_VALUE");
+    builder.from("PARAM_NAME").onChars(";").to("START");
+    if (span_actions) {
+        builder.from("PARAM_VALUE")
+            .onAnyExcept(';')
+            .spanAction([&value_bytes](std::string_view run) { value_bytes += run.size(); })
+            .to("PARAM_VALUE");
+    } else {
+        builder.from("PARAM_VALUE")
+            .onAnyExcept(';')
+            .action([&value_bytes](char) { value_bytes++; })
+            .to("PARAM_VALUE");
+    }
+    builder.from("PARAM_VALUE").onChars(";").to("PARAM_NAME");
+}
+
+static std::string makeCommandStream() {
+    std::string stream;
+    while (stream.size() < 64 * 1024) {
+        stream += "SET:KEY1=" + std::string(200, 'x') + ";KEY2=value two;;";
+    }
+    return stream;
+}
+
+static void BM_FSM_ByteParser(benchmark::State& state) {
+    std::size_t value_bytes = 0;
+    FSM<char> fsm;
+    buildCommandParser(fsm, value_bytes);
+    fsm.setInitialState("START");
+    const std::string stream = makeCommandStream();
+    
+    for (auto _ : state) {
+        for (char c : stream) {
+            fsm.process(c);
+        }
+    }
+    benchmark::DoNotOptimize(value_bytes);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stream.size()));
+}
+BENCHMARK(BM_FSM_ByteParser);
+
+// Same stream delivered as socket-sized chunks, one feed() (and one lock) per chunk
+static void BM_FSM_ByteParserFeed(benchmark::State& state) {
+    std::size_t value_bytes = 0;
+    FSM<char> fsm;
+    buildCommandParser(fsm, value_bytes);
+    fsm.setInitialState("START");
+    const std::string stream = makeCommandStream();
+    const std::size_t chunk_size = 1500;
+    
+    for (auto _ : state) {
+        std::string_view remaining(stream);
+        while (!remaining.empty()) {
+            auto chunk = remaining.substr(0, chunk_size);
+            fsm.feed(chunk);
+            remaining.remove_prefix(chunk.size());
+        }
+    }
+    benchmark::DoNotOptimize(value_bytes);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stream.size()));
+}
+BENCHMARK(BM_FSM_ByteParserFeed);
+
+static void BM_CompiledFSM_ByteParser(benchmark::State& state) {
+    std::size_t value_bytes = 0;
+    FSM<char> fsm;
+    buildCommandParser(fsm, value_bytes);
+    auto compiled = fsm.compile();
+    compiled.setInitialState("START");
+    const std::string stream = makeCommandStream();
+    
+    for (auto _ : state) {
+        for (char c : stream) {
+            compiled.process(c);
+        }
+    }
+    benchmark::DoNotOptimize(value_bytes);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stream.size()));
+}
+BENCHMARK(BM_CompiledFSM_ByteParser);
+
+// Same stream, but value runs are skipped with a vectorized scan and reported once
+static void BM_CompiledFSM_ByteParserRuns(benchmark::State& state) {
+    std::size_t value_bytes = 0;
+    FSM<char> fsm;
+    buildCommandParser(fsm, value_bytes, true);
+    auto compiled = fsm.compile();
+    compiled.setInitialState("START");
+    const std::string stream = makeCommandStream();
+    
+    for (auto _ : state) {
+        compiled.processBytes(stream);
+    }
+    benchmark::DoNotOptimize(value_bytes);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stream.size()));
+}
+BENCHMARK(BM_CompiledFSM_ByteParserRuns);
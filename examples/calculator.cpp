@@ -289,41 +289,44 @@ int main() {
         })
         .to("END");
 
-    // Create parser FSM
-    fsmgine::FSM<Token> parser;
-    Parser parser_state;
+    // Create parser FSM; its guards and actions are Parser members, and the
+    // Parser they run on is bound when the definition is instantiated
+    fsmgine::FSM<Token, std::string_view, Parser> parser_blueprint;
     
     // Build parser FSM
-    parser.get_builder()
+    parser_blueprint.get_builder()
         .from("START")
-        .predicate([&parser_state](const Token& t) { return parser_state.is_number(t); })
-        .action([&parser_state](const Token& t) { parser_state.push_number(t); })
+        .predicate(fsmgine::memberFn<&Parser::is_number>)
+        .action(fsmgine::memberFn<&Parser::push_number>)
         .to("START");
 
-    parser.get_builder()
+    parser_blueprint.get_builder()
         .from("START")
-        .predicate([&parser_state](const Token& t) { return parser_state.is_operator(t); })
-        .action([&parser_state](const Token& t) { parser_state.push_operator(t); })
+        .predicate(fsmgine::memberFn<&Parser::is_operator>)
+        .action(fsmgine::memberFn<&Parser::push_operator>)
         .to("START");
 
-    parser.get_builder()
+    parser_blueprint.get_builder()
         .from("START")
-        .predicate([&parser_state](const Token& t) { return parser_state.is_lparen(t); })
-        .action([&parser_state](const Token& t) { parser_state.push_lparen(t); })
+        .predicate(fsmgine::memberFn<&Parser::is_lparen>)
+        .action(fsmgine::memberFn<&Parser::push_lparen>)
         .to("START");
 
-    parser.get_builder()
+    parser_blueprint.get_builder()
         .from("START")
-        .predicate([&parser_state](const Token& t) { return parser_state.is_rparen(t); })
-        .action([&parser_state](const Token& t) { parser_state.handle_rparen(t); })
+        .predicate(fsmgine::memberFn<&Parser::is_rparen>)
+        .action(fsmgine::memberFn<&Parser::handle_rparen>)
         .to("START");
 
-    parser.get_builder()
+    parser_blueprint.get_builder()
         .from("START")
-        .predicate([&parser_state](const Token& t) { return parser_state.is_end(t); })
-        .action([&parser_state](const Token& t) { parser_state.finish_parsing(t); })
+        .predicate(fsmgine::memberFn<&Parser::is_end>)
+        .action(fsmgine::memberFn<&Parser::finish_parsing>)
         .to("END");
 
+    Parser parser_state;
+    fsmgine::FSMInstance<Token, Parser> parser(parser_blueprint.compileDefinition(), parser_state);
+
     // Set initial states
     tokenizer.setInitialState("START");
     parser.setInitialState("START");
@@ -16,18 +16,15 @@ public:
         std::map<std::string, std::string> params;
     };
 
-    SCPParser() {
-        setupFSM();
-    }
+    SCPParser() : parser(buildParser()) {}
 
     bool parse(const std::string& input) {
         reset();
         
-        for (char c : input) {
-            if (!fsm.process(c)) {
-                std::cout << "Error parsing at character: " << c << std::endl;
-                return false;
-            }
+        auto result = parser.feed(input);
+        if (result.rejected) {
+            std::cout << "Error parsing at character: " << input[result.consumed] << std::endl;
+            return false;
         }
         
         // Process any remaining parameter
@@ -35,7 +32,7 @@ public:
             current_message.params[current_param] = current_value;
         }
         
-        if (fsm.getCurrentState() != "END") {
+        if (parser.getCurrentState() != "END") {
             std::cout << "Incomplete message" << std::endl;
             return false;
         }
@@ -45,7 +42,8 @@ public:
     }
 
 private:
-    fsm::FSM<char> fsm;
+    // Compiled, so feed() skips each run of value bytes with one scan (see spanAction below)
+    fsm::FSMInstance<char> parser;
     SCPMessage current_message;
     std::string current_param;
     std::string current_value;
@@ -54,46 +52,47 @@ private:
         current_message = SCPMessage();
         current_param.clear();
         current_value.clear();
-        fsm.setCurrentState("START");
+        parser.setCurrentState("START");
     }
 
-    void setupFSM() {
+    fsm::FSMInstance<char> buildParser() {
+        fsm::FSM<char> fsm;
         auto builder = fsm.get_builder();
         
         // START → COMMAND
         builder.from("START")
-            .predicate([](char c) { return isalpha(c); })
+            .onChars("a-zA-Z")
             .action([this](char c) { current_message.command += c; })
             .to("COMMAND");
         
         // COMMAND → COMMAND or PARAM_NAME
         builder.from("COMMAND")
-            .predicate([](char c) { return isalnum(c); })
+            .onChars("a-zA-Z0-9")
             .action([this](char c) { current_message.command += c; })
             .to("COMMAND");
         
         builder.from("COMMAND")
-            .predicate([](char c) { return c == ':'; })
+            .onChars(":")
             .to("PARAM_NAME");
         
         // PARAM_NAME → PARAM_NAME or PARAM_VALUE
         builder.from("PARAM_NAME")
-            .predicate([](char c) { return isalnum(c); })
+            .onChars("a-zA-Z0-9")
             .action([this](char c) { current_param += c; })
             .to("PARAM_NAME");
         
         builder.from("PARAM_NAME")
-            .predicate([](char c) { return c == '='; })
+            .onChars("=")
             .to("PARAM_VALUE");
         
         // PARAM_VALUE → PARAM_VALUE or PARAM_NAME or END
         builder.from("PARAM_VALUE")
-            .predicate([](char c) { return c != ';'; })
-            .action([this](char c) { current_value += c; })
+            .onAnyExcept(';')
+            .spanAction([this](std::string_view run) { current_value.append(run); })
             .to("PARAM_VALUE");
         
         builder.from("PARAM_VALUE")
-            .predicate([](char c) { return c == ';'; })
+            .onChars(";")
             .action([this](char c) {
                 current_message.params[current_param] = current_value;
                 current_param.clear();
@@ -103,8 +102,10 @@ private:
         
         // PARAM_NAME → END (when we see a semicolon with no param)
         builder.from("PARAM_NAME")
-            .predicate([](char c) { return c == ';'; })
+            .onChars(";")
             .to("END");
+        
+        return fsm.compile();
     }
 
     void printMessage() {
@@ -133,11 +134,10 @@ public:
     bool parse(const std::string& input) {
         reset();
         
-        for (char c : input) {
-            if (!fsm.process(c)) {
-                std::cout << "Error parsing at character: " << c << std::endl;
-                return false;
-            }
+        auto result = fsm.feed(input);
+        if (result.rejected) {
+            std::cout << "Error parsing at character: " << input[result.consumed] << std::endl;
+            return false;
         }
         
         if (fsm.getCurrentState() != "END") {
@@ -165,28 +165,28 @@ private:
         
         // START → STATUS
         builder.from("START")
-            .predicate([](char c) { return isalpha(c); })
+            .onChars("a-zA-Z")
             .action([this](char c) { current_message.status += c; })
             .to("STATUS");
         
         // STATUS → STATUS or CODE
         builder.from("STATUS")
-            .predicate([](char c) { return isalpha(c); })
+            .onChars("a-zA-Z")
             .action([this](char c) { current_message.status += c; })
             .to("STATUS");
         
         builder.from("STATUS")
-            .predicate([](char c) { return c == '['; })
+            .onChars("[")
             .to("CODE");
         
         // CODE → MESSAGE
         builder.from("CODE")
-            .predicate([](char c) { return isdigit(c); })
+            .onChars("0-9")
             .action([this](char c) { code_str += c; })
             .to("CODE");
         
         builder.from("CODE")
-            .predicate([](char c) { return c == ']'; })
+            .onChars("]")
             .action([this](char c) {
                 current_message.code = std::stoi(code_str);
             })
@@ -194,17 +194,17 @@ private:
         
         // COLON → MESSAGE
         builder.from("COLON")
-            .predicate([](char c) { return c == ':'; })
+            .onChars(":")
             .to("MESSAGE");
         
         // MESSAGE → MESSAGE or END
         builder.from("MESSAGE")
-            .predicate([](char c) { return c != '\n'; })
+            .onAnyExcept('\n')
             .action([this](char c) { current_message.message += c; })
             .to("MESSAGE");
         
         builder.from("MESSAGE")
-            .predicate([](char c) { return c == '\n'; })
+            .onChars("\n")
             .to("END");
     }
 
@@ -231,11 +231,10 @@ public:
     bool parse(const std::string& input) {
         reset();
         
-        for (char c : input) {
-            if (!fsm.process(c)) {
-                std::cout << "Error parsing at character: " << c << std::endl;
-                return false;
-            }
+        auto result = fsm.feed(input);
+        if (result.rejected) {
+            std::cout << "Error parsing at character: " << input[result.consumed] << std::endl;
+            return false;
         }
         
         if (fsm.getCurrentState() != "END") {
@@ -265,38 +264,38 @@ private:
         
         // START → SECTION
         builder.from("START")
-            .predicate([](char c) { return isalpha(c); })
+            .onChars("a-zA-Z")
             .action([this](char c) { current_message.section += c; })
             .to("SECTION");
         
         // SECTION → SECTION or KEY
         builder.from("SECTION")
-            .predicate([](char c) { return isalnum(c); })
+            .onChars("a-zA-Z0-9")
             .action([this](char c) { current_message.section += c; })
             .to("SECTION");
         
         builder.from("SECTION")
-            .predicate([](char c) { return c == '{'; })
+            .onChars("{")
             .to("KEY");
         
         // KEY → KEY or VALUE
         builder.from("KEY")
-            .predicate([](char c) { return isalnum(c); })
+            .onChars("a-zA-Z0-9")
             .action([this](char c) { current_key += c; })
             .to("KEY");
         
         builder.from("KEY")
-            .predicate([](char c) { return c == '='; })
+            .onChars("=")
             .to("VALUE");
         
         // VALUE → VALUE or KEY or END
         builder.from("VALUE")
-            .predicate([](char c) { return c != '}' && c != ','; })
+            .onAnyExcept("},")
             .action([this](char c) { current_value += c; })
             .to("VALUE");
         
         builder.from("VALUE")
-            .predicate([](char c) { return c == ','; })
+            .onChars(",")
             .action([this](char c) {
                 current_message.config[current_key] = current_value;
                 current_key.clear();
@@ -305,7 +304,7 @@ private:
             .to("KEY");
         
         builder.from("VALUE")
-            .predicate([](char c) { return c == '}'; })
+            .onChars("}")
             .action([this](char c) {
                 current_message.config[current_key] = current_value;
             })
@@ -0,0 +1,116 @@
+/// @file ByteScanner.hpp
+/// @brief Vectorized search for the first byte of a character class
+/// @ingroup utilities
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include "FSMgine/CharClass.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FSMGINE_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace fsmgine {
+
+/// @brief Finds the first byte of a buffer that belongs to a fixed CharClass
+/// @ingroup utilities
+///
+/// @details Used by FSMDefinition to skip over self-loop runs: the scanner is built
+/// from the set of bytes that leave the loop and returns the first such byte.
+/// The search strategy is chosen once, at construction:
+/// - No target bytes: the whole buffer is skipped
+/// - One target byte: `memchr`
+/// - Up to MAX_NEEDLES target bytes: 16 bytes per step with SSE2 compares (scalar
+///   fallback when SSE2 is unavailable)
+/// - Larger classes: a scalar loop over the class bitmap
+class ByteScanner {
+public:
+    /// @brief Largest class searched with per-byte vector compares
+    static constexpr int MAX_NEEDLES = 4;
+
+    /// @brief Constructs a scanner that never finds anything
+    ByteScanner() = default;
+
+    /// @brief Constructs a scanner for the given target bytes
+    /// @param targets The bytes to search for
+    explicit ByteScanner(const CharClass& targets) : targets_(targets) {
+        needle_count_ = targets.count();
+        if (needle_count_ <= MAX_NEEDLES) {
+            int n = 0;
+            for (unsigned c = 0; c < 256; ++c) {
+                if (targets.contains(static_cast<unsigned char>(c))) {
+                    needles_[n++] = static_cast<unsigned char>(c);
+                }
+            }
+        }
+    }
+
+    /// @brief Finds the first target byte in [begin, end)
+    /// @param begin Start of the buffer
+    /// @param end One past the end of the buffer
+    /// @return Pointer to the first target byte, or end if there is none
+    const char* find(const char* begin, const char* end) const {
+        if (needle_count_ == 0) {
+            return end;
+        }
+        if (needle_count_ == 1) {
+            const void* hit = std::memchr(begin, needles_[0], static_cast<std::size_t>(end - begin));
+            return hit ? static_cast<const char*>(hit) : end;
+        }
+        if (needle_count_ <= MAX_NEEDLES) {
+            return findNeedles(begin, end);
+        }
+        return findInClass(begin, end);
+    }
+
+private:
+    CharClass targets_;
+    int needle_count_ = 0;
+    unsigned char needles_[MAX_NEEDLES] = {};
+
+    const char* findNeedles(const char* p, const char* end) const {
+#ifdef FSMGINE_HAS_SSE2
+        __m128i vectors[MAX_NEEDLES];
+        for (int i = 0; i < needle_count_; ++i) {
+            vectors[i] = _mm_set1_epi8(static_cast<char>(needles_[i]));
+        }
+        for (; end - p >= 16; p += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i hits = _mm_cmpeq_epi8(block, vectors[0]);
+            for (int i = 1; i < needle_count_; ++i) {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, vectors[i]));
+            }
+            int mask = _mm_movemask_epi8(hits);
+            if (mask != 0) {
+                return p + countTrailingZeros(static_cast<unsigned>(mask));
+            }
+        }
+#endif
+        return findInClass(p, end);
+    }
+
+    const char* findInClass(const char* p, const char* end) const {
+        while (p != end && !targets_.contains(static_cast<unsigned char>(*p))) {
+            ++p;
+        }
+        return p;
+    }
+
+    static int countTrailingZeros(unsigned mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctz(mask);
+#else
+        int n = 0;
+        while (!(mask & 1u)) {
+            mask >>= 1;
+            ++n;
+        }
+        return n;
+#endif
+    }
+};
+
+} // namespace fsmgine
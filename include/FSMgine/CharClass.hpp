@@ -0,0 +1,157 @@
+/// @file CharClass.hpp
+/// @brief Declarative byte-set guards for character-driven state machines
+/// @ingroup transitions
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace fsmgine {
+
+/// @brief True for event types that are a single byte (char, signed char, unsigned char)
+/// @ingroup transitions
+/// @details Byte events support character-class guards and are compiled into 256-entry
+/// dispatch tables by FSMDefinition.
+template<typename TEvent>
+inline constexpr bool is_byte_event_v =
+    std::is_same_v<TEvent, char> || std::is_same_v<TEvent, signed char> || std::is_same_v<TEvent, unsigned char>;
+
+/// @brief A set of byte values used as a declarative transition guard
+/// @ingroup transitions
+///
+/// @details Unlike an opaque predicate, a CharClass can be inspected when the FSM is
+/// compiled, which lets every state of a byte-driven machine be turned into a lookup
+/// table indexed by the input byte.
+///
+/// @par Specification Syntax
+/// parse() accepts a list of single characters and ranges, e.g. `"0-9a-zA-Z_"`.
+/// A `-` is literal when it is the first or last character, and `\` escapes the
+/// next character (so `"\\-"` is a literal dash anywhere).
+class CharClass {
+public:
+    /// @brief Constructs an empty class
+    constexpr CharClass() = default;
+
+    /// @brief Builds a class from a specification string such as `"0-9a-fA-F"`
+    /// @param spec The characters and ranges to include
+    /// @return The parsed class
+    /// @throws std::invalid_argument if a range is reversed or an escape is unterminated
+    static CharClass parse(std::string_view spec);
+
+    /// @brief Builds a class holding a single byte
+    /// @param c The byte
+    /// @return The class {c}
+    static constexpr CharClass single(unsigned char c) {
+        CharClass result;
+        result.add(c);
+        return result;
+    }
+
+    /// @brief Builds a class holding every byte
+    /// @return The class of all 256 byte values
+    static constexpr CharClass any() {
+        return CharClass().complement();
+    }
+
+    /// @brief Adds a byte to the class
+    /// @param c The byte to add
+    constexpr void add(unsigned char c) {
+        words_[c >> 6] |= std::uint64_t{1} << (c & 63);
+    }
+
+    /// @brief Adds an inclusive range of bytes to the class
+    /// @param first The first byte of the range
+    /// @param last The last byte of the range
+    constexpr void addRange(unsigned char first, unsigned char last) {
+        for (unsigned c = first; c <= last; ++c) {
+            add(static_cast<unsigned char>(c));
+        }
+    }
+
+    /// @brief Checks whether a byte belongs to the class
+    /// @param c The byte to test
+    /// @return true if c is in the class
+    constexpr bool contains(unsigned char c) const {
+        return (words_[c >> 6] >> (c & 63)) & 1u;
+    }
+
+    /// @brief Gets the complement of this class
+    /// @return A class holding exactly the bytes not in this one
+    constexpr CharClass complement() const {
+        CharClass result;
+        for (std::size_t i = 0; i < words_.size(); ++i) {
+            result.words_[i] = ~words_[i];
+        }
+        return result;
+    }
+
+    /// @brief Counts the bytes in the class
+    /// @return A value in [0, 256]
+    int count() const;
+
+    /// @brief Equality comparison
+    constexpr bool operator==(const CharClass& other) const {
+        for (std::size_t i = 0; i < words_.size(); ++i) {
+            if (words_[i] != other.words_[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// @brief Inequality comparison
+    constexpr bool operator!=(const CharClass& other) const { return !(*this == other); }
+
+private:
+    std::array<std::uint64_t, 4> words_{};
+};
+
+// --- Implementation ---
+
+inline CharClass CharClass::parse(std::string_view spec) {
+    CharClass result;
+    std::size_t i = 0;
+
+    // Reads one possibly escaped character and advances i
+    auto next = [&spec, &i]() -> unsigned char {
+        if (spec[i] == '\\') {
+            if (i + 1 >= spec.size()) {
+                throw std::invalid_argument("Unterminated escape in character class: " + std::string(spec));
+            }
+            ++i;
+        }
+        return static_cast<unsigned char>(spec[i++]);
+    };
+
+    while (i < spec.size()) {
+        unsigned char first = next();
+        if (i + 1 < spec.size() && spec[i] == '-') {
+            ++i; // Skip the dash
+            unsigned char last = next();
+            if (last < first) {
+                throw std::invalid_argument("Reversed range in character class: " + std::string(spec));
+            }
+            result.addRange(first, last);
+        } else {
+            result.add(first);
+        }
+    }
+    return result;
+}
+
+inline int CharClass::count() const {
+    int total = 0;
+    for (auto word : words_) {
+        for (; word; word &= word - 1) {
+            ++total;
+        }
+    }
+    return total;
+}
+
+} // namespace fsmgine
@@ -0,0 +1,11 @@
+/// @file CompiledFSM.hpp
+/// @brief Frozen, integer-indexed finite state machine for hot event loops
+/// @ingroup core
+///
+/// @details Convenience header for FSM::compile(). A CompiledFSM is an FSMInstance
+/// that owns its FSMDefinition; see FSMDefinition.hpp and FSMInstance.hpp.
+
+#pragma once
+
+#include "FSMgine/FSMDefinition.hpp"
+#include "FSMgine/FSMInstance.hpp"
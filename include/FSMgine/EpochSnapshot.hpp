@@ -0,0 +1,130 @@
+/// @file EpochSnapshot.hpp
+/// @brief Atomically published immutable snapshots with epoch-based reclamation
+/// @ingroup utilities
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace fsmgine {
+
+/// @brief Holds the current version of an immutable object and replaces it with one atomic swap
+/// @tparam T The snapshot type
+/// @ingroup utilities
+///
+/// @details Readers pin the current snapshot with read() and never block. A writer
+/// builds a complete replacement and installs it with publish(). The old snapshot is
+/// retired and deleted once no read section that could still see it is active.
+///
+/// Reclamation uses a global epoch and a single reader slot. A reader announces the
+/// epoch it started in before loading the snapshot pointer. A snapshot retired in epoch
+/// `e` is freed once the reader slot is empty or holds an epoch later than `e`.
+///
+/// @par Thread Safety
+/// - Read sections must not overlap each other. FSM serializes them with its processing lock.
+/// - Writers (current(), publish()) must be serialized by the caller.
+/// - A reader and a writer may run concurrently.
+template<typename T>
+class EpochSnapshot {
+public:
+    /// @brief Pins the snapshot that was current when the read section began
+    class ReadGuard {
+    public:
+        ~ReadGuard() { owner_.reader_epoch_.store(0, std::memory_order_release); }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        /// @brief Accesses the pinned snapshot
+        const T& operator*() const { return *snapshot_; }
+
+        /// @brief Accesses the pinned snapshot
+        const T* operator->() const { return snapshot_; }
+
+    private:
+        friend class EpochSnapshot;
+
+        ReadGuard(const EpochSnapshot& owner, const T* fallback) : owner_(owner) {
+            owner_.reader_epoch_.store(owner_.global_epoch_.load());
+            snapshot_ = owner_.current_.load();
+            if (snapshot_ == nullptr) {
+                snapshot_ = fallback;
+            }
+        }
+
+        const EpochSnapshot& owner_;
+        const T* snapshot_ = nullptr;
+    };
+
+    /// @brief Constructs the holder with its first snapshot
+    /// @param initial The initial snapshot; may be null, leaving the holder without one
+    explicit EpochSnapshot(std::unique_ptr<T> initial) : current_(initial.release()) {}
+
+    ~EpochSnapshot() { delete current_.load(); }
+
+    EpochSnapshot(const EpochSnapshot&) = delete;
+    EpochSnapshot& operator=(const EpochSnapshot&) = delete;
+
+    /// @brief Begins a read section
+    /// @param fallback Snapshot the guard refers to while the holder has none
+    /// @return A guard that keeps the current snapshot alive until it is destroyed
+    ReadGuard read(const T* fallback = nullptr) const { return ReadGuard(*this, fallback); }
+
+    /// @brief Checks whether a snapshot is installed
+    /// @note Writer side, like current()
+    bool hasSnapshot() const { return current_.load(std::memory_order_acquire) != nullptr; }
+
+    /// @brief Gets the current snapshot from the writer side
+    /// @return The snapshot most recently published
+    /// @note Only valid while writers are serialized and a snapshot is installed; the result
+    ///       may be retired by the next publish()
+    const T& current() const { return *current_.load(std::memory_order_acquire); }
+
+    /// @brief Gets the current snapshot for modification in place
+    /// @return The snapshot most recently published
+    /// @warning Only valid while no read section can begin, e.g. before the owner is shared
+    T& currentForUpdate() { return *current_.load(std::memory_order_acquire); }
+
+    /// @brief Installs a new snapshot and retires the previous one
+    /// @param next The replacement; must not be null
+    void publish(std::unique_ptr<T> next) {
+        T* previous = current_.exchange(next.release());
+        std::uint64_t epoch = global_epoch_.fetch_add(1);
+        retired_.push_back(Retired{std::unique_ptr<T>(previous), epoch});
+        reclaim();
+    }
+
+    /// @brief Replaces the snapshot without deferring reclamation
+    /// @param next The replacement; may be null
+    /// @return The previous snapshot
+    /// @warning Only valid when no read section is active, e.g. while moving the owner
+    std::unique_ptr<T> exchange(std::unique_ptr<T> next) {
+        retired_.clear();
+        return std::unique_ptr<T>(current_.exchange(next.release()));
+    }
+
+private:
+    struct Retired {
+        std::unique_ptr<T> snapshot;
+        std::uint64_t epoch;
+    };
+
+    // Frees every retired snapshot the active reader (if any) cannot be using
+    void reclaim() {
+        std::uint64_t reader = reader_epoch_.load();
+        retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                                      [reader](const Retired& r) { return reader == 0 || r.epoch < reader; }),
+                       retired_.end());
+    }
+
+    std::atomic<T*> current_;
+    std::atomic<std::uint64_t> global_epoch_{1};
+    mutable std::atomic<std::uint64_t> reader_epoch_{0}; // 0 when no read section is active
+    std::vector<Retired> retired_;
+};
+
+} // namespace fsmgine
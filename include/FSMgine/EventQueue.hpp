@@ -0,0 +1,148 @@
+/// @file EventQueue.hpp
+/// @brief Bounded lock-free multi-producer, single-consumer event queue
+/// @ingroup utilities
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace fsmgine {
+
+/// @brief Fixed-capacity queue that any number of threads push to and one thread pops from
+/// @tparam T The element type; must be move constructible
+/// @ingroup utilities
+///
+/// @details A ring of cells, each with a sequence number that tells producers and the
+/// consumer whose turn it is (after Dmitry Vyukov's bounded queue). A producer claims a
+/// slot with one compare-and-swap on the tail and publishes the element with a release
+/// store to the cell's sequence; the consumer reads cells in claim order, so elements
+/// come out in the order their producers claimed slots. Neither side ever takes a lock,
+/// and a full queue makes tryPush() fail rather than wait.
+///
+/// @par Thread Safety
+/// - tryPush() may be called from any number of threads concurrently.
+/// - tryPop() and the destructor must be called from one consumer at a time.
+/// - empty() may be called from any thread; off the consumer it is only a snapshot.
+template<typename T>
+class EventQueue {
+    static_assert(std::is_move_constructible_v<T>, "EventQueue elements must be move constructible");
+
+public:
+    /// @brief Constructs an empty queue
+    /// @param capacity Maximum number of queued elements; rounded up to a power of two
+    /// @throws std::invalid_argument if capacity is zero
+    explicit EventQueue(std::size_t capacity)
+        : capacity_(roundUpToPowerOfTwo(capacity)), mask_(capacity_ - 1),
+          cells_(std::make_unique<Cell[]>(capacity_)) {
+        for (std::size_t i = 0; i < capacity_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~EventQueue() {
+        while (tryPop([](T&&) {})) {
+        }
+    }
+
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    /// @brief Appends an element unless the queue is full
+    /// @param value The element to append
+    /// @return true if the element was queued, false if the queue was full
+    template<typename U>
+    bool tryPush(U&& value) {
+        std::size_t position = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[position & mask_];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::ptrdiff_t>(sequence - position);
+            if (lag == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    ::new (static_cast<void*>(cell.storage)) T(std::forward<U>(value));
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false; // The consumer has not freed this cell yet
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// @brief Removes the oldest element and passes it to a callback
+    /// @param consume Called with the element as an rvalue
+    /// @return true if an element was removed, false if the queue was empty
+    /// @note An element whose producer has claimed its slot but not finished writing it
+    ///       counts as absent; it is returned by a later call
+    template<typename Consumer>
+    bool tryPop(Consumer&& consume) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        Cell& cell = cells_[head & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != head + 1) {
+            return false;
+        }
+        T* value = std::launder(reinterpret_cast<T*>(cell.storage));
+        struct Release {
+            Cell& cell;
+            T* value;
+            std::size_t next;
+            ~Release() {
+                value->~T();
+                cell.sequence.store(next, std::memory_order_release);
+            }
+        } release{cell, value, head + capacity_};
+        head_.store(head + 1, std::memory_order_release);
+        consume(std::move(*value));
+        return true;
+    }
+
+    /// @brief Checks whether tryPop() would find an element
+    /// @return true if the oldest element is missing or not yet fully written
+    /// @note Exact on the consumer. Another thread may see a stale answer while the
+    ///       consumer is popping, but never a torn one
+    bool empty() const {
+        const std::size_t head = head_.load(std::memory_order_acquire);
+        return cells_[head & mask_].sequence.load(std::memory_order_acquire) != head + 1;
+    }
+
+    /// @brief Gets the maximum number of queued elements
+    /// @return The capacity, a power of two
+    std::size_t capacity() const { return capacity_; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence{0};
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("EventQueue capacity must be at least 1");
+        }
+        std::size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    // Producers and the consumer write different cache lines
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    const std::size_t capacity_;
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(CACHE_LINE) std::atomic<std::size_t> tail_{0}; // Next position producers claim
+    // Next position the consumer reads; atomic so empty() can be asked from other threads
+    alignas(CACHE_LINE) std::atomic<std::size_t> head_{0};
+};
+
+} // namespace fsmgine
@@ -4,17 +4,41 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <string_view>
 #include <string>
+#include <memory>
+#include <memory_resource>
 #include <unordered_map>
 #include <vector>
 #include <stdexcept>
+#include <utility>
 #include <variant> // For std::monostate
+#include "FSMgine/EventQueue.hpp"
+#include "FSMgine/LockPolicy.hpp"
 #include "FSMgine/Transition.hpp"
+#include "FSMgine/StateTraits.hpp"
 #include "FSMgine/StringInterner.hpp"
 
 #ifdef FSMGINE_MULTI_THREADED
+#include <condition_variable>
+#include <exception>
 #include <mutex>
+#include <thread>
+#include <unordered_set>
+#include "FSMgine/EpochSnapshot.hpp"
+#endif
+
+// Keeps paths that are rarely taken out of the inlined event loop
+#if defined(__GNUC__) || defined(__clang__)
+#define FSMGINE_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define FSMGINE_NOINLINE __declspec(noinline)
+#else
+#define FSMGINE_NOINLINE
 #endif
 
 /// @defgroup core Core FSM Components
@@ -23,12 +47,19 @@
 namespace fsmgine {
 
 // Forward declaration
-template<typename TEvent>
+template<typename TEvent, typename TState = std::string_view, typename TContext = void,
+         typename TLock = DefaultLockPolicy>
 class FSMBuilder;
 
-template<typename TEvent>
+template<typename TEvent, typename TState, typename TContext, typename TLock>
 class TransitionBuilder;
 
+template<typename TEvent, typename TContext = void>
+class FSMDefinition;
+
+template<typename TEvent, typename TContext = void>
+class FSMInstance;
+
 /// @brief Exception thrown when attempting to access a state that doesn't exist
 /// @ingroup core
 class FSMStateNotFoundError : public std::runtime_error {
@@ -58,8 +89,51 @@ public:
         : std::invalid_argument(message) {}
 };
 
+/// @brief Outcome of feeding a chunk of bytes to a byte-driven machine
+/// @ingroup core
+/// @details The machine keeps its state between calls, so a message split across
+/// several chunks is parsed exactly as if it had arrived in one piece.
+struct FeedResult {
+    /// @brief Number of bytes processed; also the offset at which feeding stopped
+    std::size_t consumed = 0;
+
+    /// @brief true if the byte at offset `consumed` had no matching transition
+    /// @details The rejected byte is not consumed and the current state is unchanged.
+    bool rejected = false;
+};
+
+/// @brief Outcome of processing a batch of events with processBatch()
+/// @ingroup core
+struct BatchResult {
+    /// @brief Value of first_unmatched when every event matched a transition
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /// @brief Number of events that caused a transition
+    std::size_t transitions = 0;
+
+    /// @brief Index of the first event that matched no transition, or npos
+    std::size_t first_unmatched = npos;
+};
+
+/// @brief When an FSM runs the actions of a transition
+/// @ingroup core
+enum class ActionTiming {
+    /// @brief Actions run before the target state is committed, under the processing lock
+    UnderLock,
+    
+    /// @brief The target state is committed first; the actions run after the processing
+    ///        lock is released, in commit order
+    AfterCommit
+};
+
 /// @brief A high-performance finite state machine implementation
 /// @tparam TEvent The event type used for transitions (defaults to std::monostate for event-less FSMs)
+/// @tparam TState The state type: std::string_view for named states (the default), or an
+///         enum described by StateTraits
+/// @tparam TContext Per-instance context passed to guards and actions, or void (the default)
+///         for guards and actions that carry their own state
+/// @tparam TLock The processing lock: Mutex (the default in FSMgineMT), SpinLock, or NoLock
+///         (the default, and only choice, in the single-threaded variant)
 /// @ingroup core
 /// 
 /// @details The FSM class provides a flexible and efficient state machine implementation
@@ -73,7 +147,40 @@ public:
 /// @par Thread Safety
 /// The thread-safety of FSM operations depends on which library variant you're using:
 /// - **FSMgine**: No thread synchronization, optimal for single-threaded applications
-/// - **FSMgineMT**: Full thread-safety with mutex protection on all operations
+/// - **FSMgineMT**: Full thread-safety. process(), feed(), processBatch() and state changes
+///   are serialized by a processing lock. getCurrentState() takes no lock and reads the
+///   last committed state atomically.
+/// 
+/// @par Processing Lock
+/// In the FSMgineMT variant, TLock selects the lock that process() holds, per machine.
+/// It does not change the rest of the variant's synchronization, which every machine keeps.
+/// With NoLock, only one thread may process events, but other threads may still call
+/// getCurrentState(), post() and the builder. The single-threaded FSMgine variant accepts
+/// only NoLock; the library variant, not TLock, decides whether a machine can be shared.
+/// See LockPolicy.hpp.
+/// 
+/// @par Enum States
+/// With an enum TState, states are stored in a fixed array indexed by the enum value and
+/// the builder, setInitialState() and getCurrentState() take and return enum values. No
+/// state name is hashed or interned; names for logging come from the optional reflection
+/// table of StateTraits (see getCurrentStateName()). Such machines cannot be compiled
+/// into an FSMDefinition, which addresses states by name.
+/// 
+/// @par Context Mode
+/// With a TContext, guards and actions are plain function pointers of shape
+/// `bool(*)(TContext&, const TEvent&)` and `void(*)(TContext&, const TEvent&)`; captureless
+/// lambdas and memberFn<&TContext::function> convert to them. Such an FSM is only a
+/// blueprint: it is built as usual, then compiled with compileDefinition() and driven by
+/// FSMInstance objects that each bind their own context. The definition holds no
+/// per-instance state, so any number of instances can share it.
+/// 
+/// @par Live Editing
+/// In the FSMgineMT variant, builder edits never take the processing lock. Once a state has
+/// been entered, each edit (or each edit() batch) copies the state table, sharing the states
+/// it does not touch, and publishes the copy with one atomic pointer swap. Edits made while
+/// building, before setInitialState(), apply in place. Event processing reads whichever table
+/// was current when it started, so a reload does not stall it. Replaced tables are freed
+/// once no processing call can still be using them (see EpochSnapshot).
 /// 
 /// @par Example
 /// @code{.cpp}
@@ -90,62 +197,251 @@ public:
 /// // Process events
 /// machine.process(Event{"start"});  // Transitions to "Working"
 /// @endcode
-template<typename TEvent = std::monostate>
+template<typename TEvent = std::monostate, typename TState = std::string_view, typename TContext = void,
+         typename TLock = DefaultLockPolicy>
 class FSM {
+    static_assert(is_named_state_v<TState> || std::is_enum_v<TState>,
+                  "FSM state types must be std::string_view or an enum");
+    static_assert(std::is_void_v<TContext> || is_named_state_v<TState>,
+                  "Context-mode FSMs are compiled into an FSMDefinition and need named states");
+#ifndef FSMGINE_MULTI_THREADED
+    static_assert(std::is_same_v<TLock, NoLock>, "Lock policies other than NoLock need the FSMgineMT variant");
+#endif
+
 public:
     /// @brief Type alias for transition predicates
-    /// @details Functions that evaluate whether a transition should occur based on an event
-    using Predicate = std::function<bool(const TEvent&)>;
+    /// @details Functions that evaluate whether a transition should occur based on an event.
+    /// Stored inline without heap allocation; see InlineFunction for the capture size limit.
+    /// In context mode, a function pointer taking the context first (see Callables).
+    using Predicate = typename Callables<TEvent, TContext>::Predicate;
     
     /// @brief Type alias for transition actions
-    /// @details Functions executed during transitions or state changes
-    using Action = std::function<void(const TEvent&)>;
+    /// @details Functions executed during transitions or state changes. Stored inline
+    /// without heap allocation; see InlineFunction for the capture size limit.
+    /// In context mode, a function pointer taking the context first (see Callables).
+    using Action = typename Callables<TEvent, TContext>::Action;
+    
+    /// @brief Type alias for event key extractors
+    /// @details Functions that map an event to the EventKey used by keyed transitions
+    using KeyExtractor = std::function<EventKey(const TEvent&)>;
 
 private:
-    // Internal state data structure
+    // Internal state data structure; its vectors allocate from the FSM's memory resource
     struct StateData {
-        std::vector<Action> on_enter_actions;
-        std::vector<Action> on_exit_actions;
-        std::vector<Transition<TEvent>> transitions;
+        explicit StateData(std::pmr::memory_resource* resource)
+            : on_enter_actions(resource), on_exit_actions(resource), transitions(resource) {}
+        
+        StateData(const StateData& other, std::pmr::memory_resource* resource)
+            : on_enter_actions(other.on_enter_actions, resource),
+              on_exit_actions(other.on_exit_actions, resource),
+              transitions(other.transitions, resource)
+#ifdef FSMGINE_MULTI_THREADED
+            , published_name(other.published_name)
+#endif
+        {}
+        
+        std::pmr::vector<Action> on_enter_actions;
+        std::pmr::vector<Action> on_exit_actions;
+        std::pmr::vector<Transition<TEvent, TState, TContext>> transitions;
+#ifdef FSMGINE_MULTI_THREADED
+        const TState* published_name = nullptr; // Stable state value for getCurrentState()
+#endif
+    };
+    
+    // Fixed array of states indexed by enum value, with the subset of the unordered_map
+    // interface the FSM uses. Iterators are plain pointers; absent states are null.
+    class EnumStates {
+    public:
+        using value_type = std::pair<TState, std::shared_ptr<StateData>>;
+        using iterator = const value_type*;
+        static constexpr std::size_t COUNT = StateTraits<TState>::count;
+        
+        explicit EnumStates(std::pmr::memory_resource* resource) : resource_(resource) {
+            for (std::size_t i = 0; i < COUNT; ++i) {
+                slots_[i].first = static_cast<TState>(i);
+            }
+        }
+        
+        EnumStates(const EnumStates& other, std::pmr::polymorphic_allocator<std::byte> alloc)
+            : slots_(other.slots_), resource_(alloc.resource()) {}
+        
+        std::pmr::polymorphic_allocator<std::byte> get_allocator() const { return resource_; }
+        
+        iterator find(TState state) const {
+            const auto index = static_cast<std::size_t>(state);
+            return index < COUNT && slots_[index].second ? &slots_[index] : end();
+        }
+        
+        iterator end() const { return nullptr; }
+        
+        std::shared_ptr<StateData>& operator[](TState state) {
+            const auto index = static_cast<std::size_t>(state);
+            if (index >= COUNT) {
+                throw FSMInvalidStateError("State value out of range: " + describeState(state));
+            }
+            return slots_[index].second;
+        }
+        
+        // Stable storage for each state value, used as published_name
+        static const TState* stableValue(TState state) {
+            static const std::array<TState, COUNT> values = [] {
+                std::array<TState, COUNT> all{};
+                for (std::size_t i = 0; i < COUNT; ++i) {
+                    all[i] = static_cast<TState>(i);
+                }
+                return all;
+            }();
+            return &values[static_cast<std::size_t>(state)];
+        }
+        
+    private:
+        std::array<value_type, COUNT> slots_;
+        std::pmr::memory_resource* resource_;
+    };
+    
+    using StateMap = std::conditional_t<is_named_state_v<TState>,
+                                        std::pmr::unordered_map<std::string_view, std::shared_ptr<StateData>>,
+                                        EnumStates>;
+    
+    // The machine's topology. In the MT variant each edit builds a new table, sharing
+    // unchanged StateData with the previous one, and publishes it with one atomic swap.
+    struct StateTable {
+        explicit StateTable(std::pmr::memory_resource* resource) : states(resource) {}
+        
+        // Copies stay in the source table's resource
+        StateTable(const StateTable& other)
+            : states(other.states, other.states.get_allocator()), key_extractor(other.key_extractor) {}
+        
+        std::pmr::memory_resource* resource() const { return states.get_allocator().resource(); }
+        
+        StateMap states;
+        KeyExtractor key_extractor = defaultKeyExtractor();
+    };
+    
+#ifdef FSMGINE_MULTI_THREADED
+    using TableReader = typename EpochSnapshot<StateTable>::ReadGuard;
+#else
+    using TableReader = const StateTable*;
+#endif
+
+    // Groups edits into one published table; scopes nest, and only the outermost publishes
+    class EditScope {
+    public:
+        explicit EditScope(FSM& fsm);
+        ~EditScope();
+        EditScope(const EditScope&) = delete;
+        EditScope& operator=(const EditScope&) = delete;
+        
+        // The table edits apply to
+        StateTable& table();
+        
+        // Marks the edits as complete; an uncommitted outermost scope discards them
+        void commit() { committed_ = true; }
+        
+    private:
+        FSM& fsm_;
+        bool committed_ = false;
+#ifdef FSMGINE_MULTI_THREADED
+        std::unique_lock<std::recursive_mutex> lock_;
+#endif
+    };
+
+    // Owns the event queue behind post(); created on first use, by whichever producer wins
+    class QueueHolder {
+    public:
+        QueueHolder() = default;
+        QueueHolder(QueueHolder&& other) noexcept : queue_(other.queue_.exchange(nullptr)) {}
+        QueueHolder& operator=(QueueHolder&& other) noexcept {
+            reset(other.queue_.exchange(nullptr));
+            return *this;
+        }
+        ~QueueHolder() { reset(nullptr); }
+        
+        EventQueue<TEvent>* get() const { return queue_.load(std::memory_order_acquire); }
+        EventQueue<TEvent>& getOrCreate();
+        void reset(EventQueue<TEvent>* queue) { delete queue_.exchange(queue, std::memory_order_acq_rel); }
         
-        StateData() = default;
-        StateData(const StateData&) = delete;
-        StateData& operator=(const StateData&) = delete;
-        StateData(StateData&&) = default;
-        StateData& operator=(StateData&&) = default;
+    private:
+        std::atomic<EventQueue<TEvent>*> queue_{nullptr};
     };
 
 public:
     /// @brief Default constructor
+    /// @details Allocates from std::pmr::get_default_resource() as it was at construction
     FSM() = default;
     
+    /// @brief Constructs an FSM that allocates its topology from a memory resource
+    /// @param resource Supplies the memory for states, transitions, guards and actions;
+    ///        must outlive the FSM and any FSM it is moved into
+    /// @throws std::invalid_argument if resource is null
+    /// @details Pair with a std::pmr::monotonic_buffer_resource to build a machine out of
+    /// one contiguous arena and release it all at once. With such a resource, edits made
+    /// after the machine has started keep consuming arena memory until the FSM is destroyed,
+    /// since the replaced parts of the topology are not reused.
+    /// @note State names are interned in the global StringInterner, not in this resource
+    /// @par Example
+    /// @code{.cpp}
+    /// std::array<std::byte, 64 * 1024> buffer;
+    /// std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+    /// FSM<char> parser(&arena);
+    /// @endcode
+    explicit FSM(std::pmr::memory_resource* resource)
+        : resource_(resource ? resource : throw std::invalid_argument("FSM memory resource must not be null")) {}
+    
     // Copy operations are deleted
     FSM(const FSM&) = delete;
     FSM& operator=(const FSM&) = delete;
 
     /// @brief Move constructor
     /// @param other FSM to move from
-    FSM(FSM&& other) noexcept {
+    /// @note Allocates nothing. The moved-from FSM is left uninitialized with no states;
+    ///       its next edit creates a new table
+    FSM(FSM&& other) noexcept : table_(nullptr) {
 #ifdef FSMGINE_MULTI_THREADED
-        std::unique_lock<std::mutex> lock(other.mutex_);
+        std::scoped_lock lock(other.mutex_, other.edit_mutex_);
+        resource_ = other.resource_;
+        table_.exchange(other.table_.exchange(nullptr));
+        state_names_ = std::move(other.state_names_);
+        started_ = other.started_;
+        // StateData objects move with the table, so the published name pointer stays valid
+        published_state_.store(other.published_state_.exchange(nullptr), std::memory_order_release);
+        combining_slots_ = std::move(other.combining_slots_);
+        combining_slot_count_ = std::exchange(other.combining_slot_count_, 0);
+#else
+        resource_ = other.resource_;
+        table_ = std::move(other.table_);
 #endif
-        states_ = std::move(other.states_);
-        current_state_ = other.current_state_;
-        has_initial_state_ = other.has_initial_state_;
+        current_state_ = std::exchange(other.current_state_, TState{});
+        has_initial_state_ = std::exchange(other.has_initial_state_, false);
+        queue_ = std::move(other.queue_);
+        action_timing_ = other.action_timing_;
+        flat_combining_ = std::exchange(other.flat_combining_, false);
     }
 
     /// @brief Move assignment operator
     /// @param other FSM to move from
     /// @return Reference to this FSM
+    /// @note Allocates nothing; the moved-from FSM is left as by the move constructor
     FSM& operator=(FSM&& other) noexcept {
         if (this != &other) {
 #ifdef FSMGINE_MULTI_THREADED
-            std::unique_lock<std::mutex> lock(mutex_);
-            std::unique_lock<std::mutex> other_lock(other.mutex_);
+            std::scoped_lock lock(mutex_, edit_mutex_, other.mutex_, other.edit_mutex_);
+            resource_ = other.resource_;
+            table_.exchange(other.table_.exchange(nullptr));
+            state_names_ = std::move(other.state_names_);
+            started_ = other.started_;
+            published_state_.store(other.published_state_.exchange(nullptr), std::memory_order_release);
+            combining_slots_ = std::move(other.combining_slots_);
+            combining_slot_count_ = std::exchange(other.combining_slot_count_, 0);
+#else
+            resource_ = other.resource_;
+            table_ = std::move(other.table_);
 #endif
-            states_ = std::move(other.states_);
-            current_state_ = other.current_state_;
-            has_initial_state_ = other.has_initial_state_;
+            current_state_ = std::exchange(other.current_state_, TState{});
+            has_initial_state_ = std::exchange(other.has_initial_state_, false);
+            queue_ = std::move(other.queue_);
+            action_timing_ = other.action_timing_;
+            flat_combining_ = std::exchange(other.flat_combining_, false);
         }
         return *this;
     }
@@ -158,31 +454,74 @@ public:
     ///    .from("A").to("B").when([](const auto& e) { return true; })
     ///    .build("A");
     /// @endcode
-    FSMBuilder<TEvent> get_builder();
+    FSMBuilder<TEvent, TState, TContext, TLock> get_builder();
+    
+    /// @brief Applies several builder edits as one update
+    /// @tparam Edits Callable taking an FSMBuilder<TEvent, TState, TContext, TLock>&
+    /// @param edits Makes the edits through the builder it is given
+    /// @details In the FSMgineMT variant the edits are collected into one new table that
+    /// process() sees all at once or not at all, and if the callable throws none of them
+    /// are applied. In the single-threaded variant each edit applies immediately.
+    /// @par Example
+    /// @code{.cpp}
+    /// fsm.edit([](FSMBuilder<Event>& builder) {
+    ///     builder.from("A").predicate(isReload).to("B");
+    ///     builder.from("B").to("A");
+    /// });
+    /// @endcode
+    template<typename Edits>
+    void edit(Edits&& edits);
+    
+    /// @brief Freezes the current topology into a shareable, integer-indexed definition
+    /// @return An immutable FSMDefinition holding a snapshot of all states, transitions and actions
+    /// @throws FSMInvalidStateError if a transition has no target state
+    /// @note Include FSMgine/FSMDefinition.hpp to use this method
+    /// @note The definition is independent of this FSM; later edits are not reflected
+    /// @note Only available for named states (TState = std::string_view)
+    std::shared_ptr<const FSMDefinition<TEvent, TContext>> compileDefinition() const;
+    
+    /// @brief Freezes the current topology into a self-contained compiled machine
+    /// @return A CompiledFSM (an FSMInstance owning a fresh definition), not yet initialized
+    /// @throws FSMInvalidStateError if a transition has no target state
+    /// @note Include FSMgine/CompiledFSM.hpp to use this method
+    /// @note Only available for named states (TState = std::string_view)
+    /// @note Not available in context mode; construct FSMInstance objects from
+    ///       compileDefinition() with their contexts instead
+    FSMInstance<TEvent, TContext> compile() const;
     
     /// @brief Sets the initial state of the FSM
-    /// @param state The name of the initial state
+    /// @param state The initial state
     /// @throws FSMInvalidStateError if the state doesn't exist
     /// @note This also executes any on-enter actions for the initial state
-    void setInitialState(std::string_view state);
+    void setInitialState(TState state);
     
     /// @brief Changes the current state of the FSM
-    /// @param state The name of the state to transition to
+    /// @param state The state to transition to
     /// @throws FSMInvalidStateError if the state doesn't exist
     /// @note This executes on-exit actions for the current state and on-enter actions for the new state
-    void setCurrentState(std::string_view state);
+    void setCurrentState(TState state);
+    
+    /// @brief Gets the current state
+    /// @return The current state name, or enum value for enum-typed states
+    /// @throws FSMNotInitializedError if no initial state has been set
+    /// @note In the FSMgineMT variant this call is wait-free: it reads the last committed
+    ///       state without taking the lock. A state is committed once its on-enter actions
+    ///       have run, so during a transition observers still see the previous state.
+    TState getCurrentState() const;
     
     /// @brief Gets the name of the current state
-    /// @return The current state name
+    /// @return The state name; for enum states the StateTraits reflection name, or an
+    ///         empty view if the enum has no name table
     /// @throws FSMNotInitializedError if no initial state has been set
-    std::string_view getCurrentState() const;
+    std::string_view getCurrentStateName() const { return stateName(getCurrentState()); }
     
     /// @brief Processes an event and potentially transitions to a new state
     /// @param event The event to process
     /// @return true if a transition occurred, false otherwise
     /// @throws FSMNotInitializedError if no initial state has been set
     /// @throws FSMStateNotFoundError if the current state is invalid
-    /// @throws FSMInvalidStateError if a transition has no target state
+    /// @throws FSMInvalidStateError if a transition has no target state, or a keyed
+    ///         transition is reached without a key extractor
     bool process(const TEvent& event);
     
     /// @brief Processes a transition for event-less FSMs
@@ -193,59 +532,370 @@ public:
         return process(std::monostate{});
     }
     
+    /// @brief Processes a sequence of events in order
+    /// @tparam InputIt Input iterator whose value type converts to TEvent
+    /// @param first Iterator to the first event
+    /// @param last Iterator past the last event
+    /// @return The number of transitions taken and the index of the first unmatched event
+    /// @throws FSMNotInitializedError if no initial state has been set
+    /// @throws FSMStateNotFoundError if the current state is invalid
+    /// @throws FSMInvalidStateError under the same conditions as process()
+    /// @note Events that match no transition are skipped; processing continues with the next one
+    /// @note In the FSMgineMT variant the whole batch is processed under one lock, and the
+    ///       current state is resolved once rather than per event
+    template<typename InputIt>
+    BatchResult processBatch(InputIt first, InputIt last);
+    
+    /// @brief Default capacity of the event queue behind post()
+    static constexpr std::size_t DEFAULT_QUEUE_CAPACITY = 1024;
+    
+    /// @brief Queues an event for a later drain() instead of processing it
+    /// @param event The event to queue
+    /// @return true if the event was queued, false if the queue is full
+    /// @details Producers never take the processing lock and never run actions, so a
+    /// slow action on the consumer cannot block them. The queue is a bounded lock-free
+    /// EventQueue, created with DEFAULT_QUEUE_CAPACITY slots on first use unless
+    /// setQueueCapacity() was called.
+    /// @note Safe to call from any number of threads in both library variants
+    bool post(const TEvent& event);
+    
+    /// @brief Queues an event for a later drain(), moving it into the queue
+    /// @param event The event to queue
+    /// @return true if the event was queued, false if the queue is full
+    bool post(TEvent&& event);
+    
+    /// @brief Processes queued events in the order they were posted
+    /// @return The number of transitions taken and the index, counted from the first
+    ///         event of this drain, of the first unmatched event
+    /// @throws FSMNotInitializedError if no initial state has been set
+    /// @throws FSMStateNotFoundError if the current state is invalid
+    /// @throws FSMInvalidStateError under the same conditions as process()
+    /// @note Call from one consumer thread at a time. Processes at most the queue's
+    ///       capacity of events, so it returns even while producers keep posting.
+    /// @note In the FSMgineMT variant the whole drain is processed under one lock
+    BatchResult drain();
+    
+    /// @brief Replaces the event queue behind post() with one of the given capacity
+    /// @param capacity Maximum number of queued events; rounded up to a power of two
+    /// @throws std::invalid_argument if capacity is zero
+    /// @note Discards queued events; call before producers start posting
+    void setQueueCapacity(std::size_t capacity);
+    
+    /// @brief Queues an event from inside an action, to be processed once the current
+    ///        event has run to completion
+    /// @param event The event to queue
+    /// @throws FSMInvalidStateError with ActionTiming::AfterCommit
+    /// @details An action that calls process() on its own FSM deadlocks in the FSMgineMT
+    /// variant and, in the single-threaded one, starts a transition in the middle of the
+    /// current one. postInternal() instead appends to an internal queue. Before the
+    /// process(), processBatch(), drain(), feed(), setInitialState() or setCurrentState()
+    /// call that ran the action returns, it processes the queued events in order,
+    /// including any they post in turn. Batch calls finish each event's internal events
+    /// before moving on to the next event. The queue reuses its storage, so steady-state
+    /// posting does not allocate.
+    /// @note Call only from an action running on this FSM; it takes no lock
+    /// @note Results of internal events are not reported. If one throws, the remaining
+    ///       internal events are discarded.
+    void postInternal(const TEvent& event);
+    
+    /// @brief Queues an event from inside an action, moving it into the queue
+    /// @param event The event to queue
+    /// @throws FSMInvalidStateError with ActionTiming::AfterCommit
+    void postInternal(TEvent&& event);
+    
+    /// @brief Chooses when transition, on-exit and on-enter actions run
+    /// @param timing ActionTiming::UnderLock (the default) or ActionTiming::AfterCommit
+    /// @details With AfterCommit, an event holds the processing lock only while guards are
+    /// tested and the target state is committed. Its actions run after the lock is released,
+    /// so a slow action no longer stalls other threads processing events. Each transition
+    /// takes a sequence number under the lock and runs its actions once those of the
+    /// previous transition have finished, so actions still run one at a time, in commit
+    /// order. processBatch(), drain() and feed() commit each event separately in this mode.
+    /// setInitialState() and setCurrentState() wait for outstanding actions, then run their
+    /// own under the lock.
+    /// @note Actions see the target state already committed
+    /// @note In the FSMgineMT variant an action must not process events on its own FSM in
+    ///       this mode; the nested call would wait for the action to finish
+    /// @note In the FSMgineMT variant, processing threads may release replaced topology
+    ///       in this mode. An FSM built on a memory resource then needs one that is
+    ///       thread-safe or never frees, e.g. std::pmr::monotonic_buffer_resource.
+    /// @note Set before events are processed
+    void setActionTiming(ActionTiming timing);
+    
+    /// @brief Gets when actions run
+    /// @return The timing set with setActionTiming()
+    ActionTiming getActionTiming() const { return action_timing_; }
+    
+    /// @brief Turns flat combining of concurrent process() calls on or off
+    /// @param enabled true to combine, false (the default) to take the lock per call
+    /// @details Under heavy contention most of the cost of process() is handing the lock
+    /// from thread to thread. With flat combining, a caller parks its event in a
+    /// publication slot and tries to take the lock. The thread that gets it processes
+    /// every parked event in one pass and hands each caller its result or exception; the
+    /// others wait for their slot to be served without queuing on the lock. Events from
+    /// different threads are processed in slot order, not arrival order. Events from one
+    /// thread keep their order, since a caller waits for its own result.
+    /// @note Only affects process() with ActionTiming::UnderLock. Has no effect in the
+    ///       single-threaded variant.
+    /// @note Set before events are processed
+    void setFlatCombining(bool enabled);
+    
+    /// @brief Checks whether flat combining is on
+    /// @return The value set with setFlatCombining()
+    bool isFlatCombining() const { return flat_combining_; }
+    
+    /// @brief Processes a buffer of bytes as consecutive events
+    /// @param chunk The bytes to process; may be any fragment of a longer stream
+    /// @return How many bytes were consumed and whether a byte was rejected
+    /// @throws FSMNotInitializedError if no initial state has been set
+    /// @note This method is only available for byte events (char, signed char, unsigned char)
+    /// @note In the FSMgineMT variant the whole chunk is processed under one lock
+    FeedResult feed(std::string_view chunk);
+    
 private:
     // Friend declarations for builder access
-    friend class FSMBuilder<TEvent>;
-    friend class TransitionBuilder<TEvent>;
+    friend class FSMBuilder<TEvent, TState, TContext, TLock>;
+    friend class TransitionBuilder<TEvent, TState, TContext, TLock>;
+    friend class FSMDefinition<TEvent, TContext>;
     
     // Adds a transition from a state (internal use by builder)
-    void addTransition(std::string_view from_state, Transition<TEvent> transition);
+    void addTransition(TState from_state, Transition<TEvent, TState, TContext> transition);
     
     // Adds an on-enter action to a state (internal use by builder)
-    void addOnEnterAction(std::string_view state, Action action);
+    void addOnEnterAction(TState state, Action action);
     
     // Adds an on-exit action to a state (internal use by builder)
-    void addOnExitAction(std::string_view state, Action action);
+    void addOnExitAction(TState state, Action action);
+    
+    // Interns state names; enum states are returned unchanged
+    static TState internState(TState state);
+    
+    // Sets the event key extractor used by keyed transitions (internal use by builder)
+    void setKeyExtractor(KeyExtractor extractor);
+    
+    // Identity extractor for enum and integral events, index() for variants; empty otherwise
+    static KeyExtractor defaultKeyExtractor();
+    
+    // Pins the current table for the processing side (caller holds mutex_ in the MT variant)
+    TableReader readTable() const;
+    
+    // Stands in for the table of a moved-from FSM until its next edit creates one
+    static const StateTable& emptyTable();
+    
+    // Switches editors to copy-on-write before the first state is entered (caller holds mutex_)
+    void markStarted();
+    
+    // The current table as seen by editors (caller holds edit_mutex_ in the MT variant)
+    const StateTable& editorTable() const;
+    
+    // Gets a state of an edited table for modification, creating it if needed and copying
+    // it first if it is shared with a published table
+    StateData& editState(StateTable& table, TState state);
+    
+    // Commits the current state for lock-free readers
+    void publishCurrentState(const StateData& state_data);
+    
+    // Looks up the data of the current state (caller holds mutex_ in the MT variant)
+    const std::shared_ptr<StateData>& resolveCurrentState(const StateTable& table) const;
+    
+    // Finds the transition an event takes from a state and sets target to the table
+    // entry of its target state (caller holds mutex_ in the MT variant)
+    const Transition<TEvent, TState, TContext>* findTransition(const StateTable& table, const StateData& state_data,
+                                                               const TEvent& event,
+                                                               const std::shared_ptr<StateData>*& target) const;
+    
+    // Processes one event from an already resolved state; on a transition, state_data
+    // is updated to the target state (caller holds mutex_ in the MT variant)
+    bool processFrom(const StateTable& table, const StateData*& state_data, const TEvent& event);
+    
+    // Processes the events queued by postInternal(), starting from an already resolved
+    // state (caller holds mutex_ in the MT variant)
+    void runToCompletion(const StateTable& table, const StateData*& state_data);
+    
+    // Processes one event in ActionTiming::AfterCommit mode; takes mutex_ itself
+    FSMGINE_NOINLINE bool processAfterCommit(const TEvent& event);
+    
+#ifdef FSMGINE_MULTI_THREADED
+    // Holds an AfterCommit transition's turn to run actions, from its ticket until destroyed
+    class ActionTurn {
+    public:
+        ActionTurn(FSM& fsm, std::uint64_t ticket);
+        ~ActionTurn();
+        ActionTurn(const ActionTurn&) = delete;
+        ActionTurn& operator=(const ActionTurn&) = delete;
+        
+    private:
+        FSM& fsm_;
+    };
+    
+    // Waits until every issued turn has finished (caller holds mutex_)
+    void waitForDeferredActions();
+    
+    // A publication slot for flat combining; one cache line each
+    struct alignas(64) CombiningSlot {
+        enum : int { FREE, CLAIMED, PENDING, DONE };
+        
+        std::atomic<int> state{FREE};
+        const TEvent* event = nullptr; // Owned by the waiting caller
+        bool result = false;
+        std::exception_ptr error;
+    };
+    
+    // Processes one event through the combining slots; takes mutex_ itself
+    FSMGINE_NOINLINE bool processCombined(const TEvent& event);
+    
+    // Serves every pending slot, starting from state_data if it is resolved already
+    // (caller holds mutex_)
+    void combine(const StateTable& table, const StateData* state_data);
+#endif
 
-    std::unordered_map<std::string_view, StateData> states_;
-    std::string_view current_state_;
+    TState current_state_{};
     bool has_initial_state_ = false;
     
+    // Source of all topology storage; declared before table_, which is built from it
+    std::pmr::memory_resource* resource_ = std::pmr::get_default_resource();
+    
 #ifdef FSMGINE_MULTI_THREADED
-    mutable std::mutex mutex_;
+    // Serializes event processing and state changes (see LockPolicy.hpp)
+    mutable TLock mutex_;
+    
+    // Serializes editors; recursive so that edit() can wrap builder calls
+    mutable std::recursive_mutex edit_mutex_;
+    
+    // AfterCommit turns: tickets are issued under mutex_, and the transition holding ticket
+    // n runs its actions once actions_done_ reaches n
+    std::uint64_t next_ticket_ = 0;
+    std::uint64_t actions_done_ = 0; // Guarded by turn_mutex_
+    std::mutex turn_mutex_;
+    std::condition_variable turn_;
+    
+    // Flat combining slots, allocated by the first setFlatCombining(true)
+    std::unique_ptr<CombiningSlot[]> combining_slots_;
+    std::size_t combining_slot_count_ = 0;
+    std::atomic<std::size_t> combining_parked_{0}; // Never below the number of PENDING slots
+    
+    EpochSnapshot<StateTable> table_{std::make_unique<StateTable>(resource_)};
+    std::unique_ptr<StateTable> draft_; // Table being edited by the outermost EditScope
+    int edit_depth_ = 0;
+    
+    // Set, under both locks, when a state is first entered. Before that nothing reads the
+    // table and edits apply in place; afterwards they copy on write.
+    bool started_ = false;
+    
+    // Grow-only set of state names; StateData::published_name points into it (named states only)
+    std::unordered_set<std::string_view> state_names_;
+    
+    // The committed current state, read by getCurrentState() without locking
+    std::atomic<const TState*> published_state_{nullptr};
+    static_assert(std::atomic<const TState*>::is_always_lock_free,
+                  "getCurrentState() relies on lock-free pointer atomics");
+#else
+    std::unique_ptr<StateTable> table_ = std::make_unique<StateTable>(resource_);
 #endif
 
+    QueueHolder queue_;
+    ActionTiming action_timing_ = ActionTiming::UnderLock;
+    bool flat_combining_ = false;
+    
+    // Events queued by postInternal(); the unprocessed ones start at internal_head_
+    std::vector<TEvent> internal_events_;
+    std::size_t internal_head_ = 0;
+    bool completing_ = false; // Set while runToCompletion() is draining internal_events_
+
     // Helper methods
-    StateData& getOrCreateState(std::string_view state);
-    void executeOnExitActions(std::string_view state, const TEvent& event) const;
-    void executeOnEnterActions(std::string_view state, const TEvent& event) const;
+    void executeOnExitActions(const StateData& state_data, const TEvent& event) const;
+    void executeOnEnterActions(const StateData& state_data, const TEvent& event) const;
 };
 
 // --- Implementation ---
 
-template<typename TEvent>
-FSMBuilder<TEvent> FSM<TEvent>::get_builder() {
-    return FSMBuilder<TEvent>(*this);
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+FSM<TEvent, TState, TContext, TLock>::EditScope::EditScope(FSM& fsm)
+    : fsm_(fsm)
+#ifdef FSMGINE_MULTI_THREADED
+    , lock_(fsm.edit_mutex_)
+#endif
+{
+#ifdef FSMGINE_MULTI_THREADED
+    if (!fsm_.table_.hasSnapshot()) {
+        fsm_.table_.publish(std::make_unique<StateTable>(fsm_.resource_)); // Moved from
+    }
+    // Until the machine is started nothing reads the table, so edits apply in place
+    if (fsm_.edit_depth_++ == 0 && fsm_.started_) {
+        fsm_.draft_ = std::make_unique<StateTable>(fsm_.table_.current());
+    }
+#endif
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+FSM<TEvent, TState, TContext, TLock>::EditScope::~EditScope() {
+#ifdef FSMGINE_MULTI_THREADED
+    if (--fsm_.edit_depth_ == 0 && fsm_.draft_) {
+        if (committed_) {
+            fsm_.table_.publish(std::move(fsm_.draft_));
+        } else {
+            fsm_.draft_.reset();
+        }
+    }
+#endif
 }
 
-template<typename TEvent>
-void FSM<TEvent>::setInitialState(std::string_view state) {
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+typename FSM<TEvent, TState, TContext, TLock>::StateTable& FSM<TEvent, TState, TContext, TLock>::EditScope::table() {
 #ifdef FSMGINE_MULTI_THREADED
-    std::unique_lock<std::mutex> lock(mutex_);
+    return fsm_.draft_ ? *fsm_.draft_ : fsm_.table_.currentForUpdate();
+#else
+    if (!fsm_.table_) {
+        fsm_.table_ = std::make_unique<StateTable>(fsm_.resource_); // Moved from
+    }
+    return *fsm_.table_;
 #endif
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+FSMBuilder<TEvent, TState, TContext, TLock> FSM<TEvent, TState, TContext, TLock>::get_builder() {
+    return FSMBuilder<TEvent, TState, TContext, TLock>(*this);
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+template<typename Edits>
+void FSM<TEvent, TState, TContext, TLock>::edit(Edits&& edits) {
+    EditScope scope(*this);
+    auto builder = get_builder();
+    edits(builder);
+    scope.commit();
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+std::shared_ptr<const FSMDefinition<TEvent, TContext>> FSM<TEvent, TState, TContext, TLock>::compileDefinition() const {
+    static_assert(is_named_state_v<TState>, "compileDefinition() requires named states (TState = std::string_view)");
+    return std::make_shared<const FSMDefinition<TEvent, TContext>>(*this);
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+FSMInstance<TEvent, TContext> FSM<TEvent, TState, TContext, TLock>::compile() const {
+    static_assert(std::is_void_v<TContext>, "Context-mode definitions are bound to contexts by FSMInstance");
+    return FSMInstance<TEvent, TContext>(compileDefinition());
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::setInitialState(TState state) {
+    static_assert(std::is_void_v<TContext>, "Context-mode FSMs are driven through FSMInstance");
+#ifdef FSMGINE_MULTI_THREADED
+    std::unique_lock<TLock> lock(mutex_);
+    markStarted();
+    waitForDeferredActions();
+#endif
+    auto table = readTable();
     
-    // Optimization 1: Cache StringInterner reference
-    auto& interner = StringInterner::instance();
-    auto interned_state = interner.intern(state);
+    auto interned_state = internState(state);
     
     // Optimization 2: Single map lookup instead of redundant find
-    auto it = states_.find(interned_state);
-    if (it == states_.end()) {
+    auto it = table->states.find(interned_state);
+    if (it == table->states.end()) {
         // Optimization 3: Optimized exception string construction
-        std::string error_msg;
-        error_msg.reserve(50 + state.size());
-        error_msg.append("Cannot set initial state to undefined state: ");
-        error_msg.append(state);
+        std::string error_msg("Cannot set initial state to undefined state: ");
+        error_msg.append(describeState(state));
         throw FSMInvalidStateError(error_msg);
     }
     
@@ -254,180 +904,655 @@ void FSM<TEvent>::setInitialState(std::string_view state) {
     
     // Optimization 4: Static dummy event to avoid repeated object construction
     static const TEvent dummy_event{};
-    executeOnEnterActions(current_state_, dummy_event);
+    executeOnEnterActions(*it->second, dummy_event);
+    publishCurrentState(*it->second);
+    
+    const StateData* state_data = it->second.get();
+    runToCompletion(*table, state_data);
 }
 
-template<typename TEvent>
-void FSM<TEvent>::setCurrentState(std::string_view state) {
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::setCurrentState(TState state) {
+    static_assert(std::is_void_v<TContext>, "Context-mode FSMs are driven through FSMInstance");
 #ifdef FSMGINE_MULTI_THREADED
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<TLock> lock(mutex_);
+    markStarted();
+    waitForDeferredActions();
 #endif
+    auto table = readTable();
     
-    // Optimization 1: Cache StringInterner reference
-    auto& interner = StringInterner::instance();
-    auto interned_state = interner.intern(state);
+    auto interned_state = internState(state);
     
     // Optimization 2: Single map lookup instead of redundant find
-    auto it = states_.find(interned_state);
-    if (it == states_.end()) {
+    auto it = table->states.find(interned_state);
+    if (it == table->states.end()) {
         // Optimization 3: Optimized exception string construction
-        std::string error_msg;
-        error_msg.reserve(50 + state.size());
-        error_msg.append("Cannot set current state to undefined state: ");
-        error_msg.append(state);
+        std::string error_msg("Cannot set current state to undefined state: ");
+        error_msg.append(describeState(state));
         throw FSMInvalidStateError(error_msg);
     }
     
     // Optimization 4: Static dummy event to avoid repeated object construction
     static const TEvent dummy_event{};
     if (has_initial_state_ && current_state_ != interned_state) {
-        executeOnExitActions(current_state_, dummy_event);
+        executeOnExitActions(*resolveCurrentState(*table), dummy_event);
     }
     
     current_state_ = interned_state;
     has_initial_state_ = true;
     
-    executeOnEnterActions(current_state_, dummy_event);
+    executeOnEnterActions(*it->second, dummy_event);
+    publishCurrentState(*it->second);
+    
+    const StateData* state_data = it->second.get();
+    runToCompletion(*table, state_data);
 }
 
-template<typename TEvent>
-bool FSM<TEvent>::process(const TEvent& event) {
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+bool FSM<TEvent, TState, TContext, TLock>::process(const TEvent& event) {
+    static_assert(std::is_void_v<TContext>, "Context-mode FSMs are driven through FSMInstance");
+    if (action_timing_ == ActionTiming::AfterCommit) {
+        return processAfterCommit(event);
+    }
 #ifdef FSMGINE_MULTI_THREADED
-    std::unique_lock<std::mutex> lock(mutex_);
+    if (flat_combining_) {
+        return processCombined(event);
+    }
+    std::unique_lock<TLock> lock(mutex_);
 #endif
+    auto table = readTable();
     
+    const StateData* state_data = resolveCurrentState(*table).get();
+    return processFrom(*table, state_data, event);
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+template<typename InputIt>
+BatchResult FSM<TEvent, TState, TContext, TLock>::processBatch(InputIt first, InputIt last) {
+    static_assert(std::is_void_v<TContext>, "Context-mode FSMs are driven through FSMInstance");
+    BatchResult result;
+    if (action_timing_ == ActionTiming::AfterCommit) {
+        for (std::size_t index = 0; first != last; ++first, ++index) {
+            if (processAfterCommit(*first)) {
+                ++result.transitions;
+            } else if (result.first_unmatched == BatchResult::npos) {
+                result.first_unmatched = index;
+            }
+        }
+        return result;
+    }
+#ifdef FSMGINE_MULTI_THREADED
+    std::unique_lock<TLock> lock(mutex_);
+#endif
+    auto table = readTable();
+    
+    const StateData* state_data = resolveCurrentState(*table).get();
+    for (std::size_t index = 0; first != last; ++first, ++index) {
+        if (processFrom(*table, state_data, *first)) {
+            ++result.transitions;
+        } else if (result.first_unmatched == BatchResult::npos) {
+            result.first_unmatched = index;
+        }
+    }
+    return result;
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+EventQueue<TEvent>& FSM<TEvent, TState, TContext, TLock>::QueueHolder::getOrCreate() {
+    EventQueue<TEvent>* queue = get();
+    if (queue) {
+        return *queue;
+    }
+    auto created = std::make_unique<EventQueue<TEvent>>(DEFAULT_QUEUE_CAPACITY);
+    if (queue_.compare_exchange_strong(queue, created.get(), std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+        return *created.release();
+    }
+    return *queue; // Another producer installed its queue first
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+bool FSM<TEvent, TState, TContext, TLock>::post(const TEvent& event) {
+    return queue_.getOrCreate().tryPush(event);
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+bool FSM<TEvent, TState, TContext, TLock>::post(TEvent&& event) {
+    return queue_.getOrCreate().tryPush(std::move(event));
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+BatchResult FSM<TEvent, TState, TContext, TLock>::drain() {
+    static_assert(std::is_void_v<TContext>, "Context-mode FSMs are driven through FSMInstance");
+    BatchResult result;
+    EventQueue<TEvent>* queue = queue_.get();
+    if (!queue) {
+        return result;
+    }
+    if (action_timing_ == ActionTiming::AfterCommit) {
+        for (std::size_t index = 0; index < queue->capacity(); ++index) {
+            bool popped = queue->tryPop([&](TEvent&& event) {
+                if (processAfterCommit(event)) {
+                    ++result.transitions;
+                } else if (result.first_unmatched == BatchResult::npos) {
+                    result.first_unmatched = index;
+                }
+            });
+            if (!popped) {
+                break;
+            }
+        }
+        return result;
+    }
+#ifdef FSMGINE_MULTI_THREADED
+    std::unique_lock<TLock> lock(mutex_);
+#endif
+    auto table = readTable();
+    
+    const StateData* state_data = resolveCurrentState(*table).get();
+    for (std::size_t index = 0; index < queue->capacity(); ++index) {
+        bool popped = queue->tryPop([&](TEvent&& event) {
+            if (processFrom(*table, state_data, event)) {
+                ++result.transitions;
+            } else if (result.first_unmatched == BatchResult::npos) {
+                result.first_unmatched = index;
+            }
+        });
+        if (!popped) {
+            break;
+        }
+    }
+    return result;
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::setQueueCapacity(std::size_t capacity) {
+    queue_.reset(new EventQueue<TEvent>(capacity));
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+FeedResult FSM<TEvent, TState, TContext, TLock>::feed(std::string_view chunk) {
+    static_assert(std::is_void_v<TContext>, "Context-mode FSMs are driven through FSMInstance");
+    static_assert(is_byte_event_v<TEvent>, "feed() can only be used with byte events (char, signed char, unsigned char).");
+    FeedResult result;
+    if (action_timing_ == ActionTiming::AfterCommit) {
+        for (char c : chunk) {
+            if (!processAfterCommit(static_cast<TEvent>(c))) {
+                result.rejected = true;
+                break;
+            }
+            ++result.consumed;
+        }
+        return result;
+    }
+#ifdef FSMGINE_MULTI_THREADED
+    std::unique_lock<TLock> lock(mutex_);
+#endif
+    auto table = readTable();
+    
+    const StateData* state_data = resolveCurrentState(*table).get();
+    for (char c : chunk) {
+        if (!processFrom(*table, state_data, static_cast<TEvent>(c))) {
+            result.rejected = true;
+            break;
+        }
+        ++result.consumed;
+    }
+    return result;
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+const std::shared_ptr<typename FSM<TEvent, TState, TContext, TLock>::StateData>& FSM<TEvent, TState, TContext, TLock>::resolveCurrentState(const StateTable& table) const {
     if (!has_initial_state_) {
         throw FSMNotInitializedError();
     }
     
-    auto it = states_.find(current_state_);
-    if (it == states_.end()) {
-        throw FSMStateNotFoundError(std::string(current_state_));
+    auto it = table.states.find(current_state_);
+    if (it == table.states.end()) {
+        throw FSMStateNotFoundError(describeState(current_state_));
     }
     
-    const auto& state_data = it->second;
+    return it->second;
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+const Transition<TEvent, TState, TContext>* FSM<TEvent, TState, TContext, TLock>::findTransition(
+    const StateTable& table, const StateData& state_data, const TEvent& event,
+    const std::shared_ptr<StateData>*& target) const {
+    // The event key is extracted at most once, on the first keyed transition
+    EventKey event_key = 0;
+    bool has_event_key = false;
     
     for (const auto& transition : state_data.transitions) {
+        if (transition.hasKey()) {
+            if (!has_event_key) {
+                if (!table.key_extractor) {
+                    throw FSMInvalidStateError("Keyed transition requires a key extractor");
+                }
+                event_key = table.key_extractor(event);
+                has_event_key = true;
+            }
+            if (event_key != transition.getKey()) {
+                continue;
+            }
+        }
+        
         if (transition.predicatesPass(event)) {
-            auto target_state = transition.getTargetState();
-            
-            if (target_state.empty()) {
+            if (!transition.hasTargetState()) {
                 throw FSMInvalidStateError("Transition has no target state");
             }
+            auto target_state = transition.getTargetState();
             
             // Optimization 1: Combine target state validation with lookup needed later
-            auto target_it = states_.find(target_state);
-            if (target_it == states_.end()) {
-                throw FSMStateNotFoundError(std::string(target_state));
-            }
-            
-            transition.executeActions(event);
-            
-            if (current_state_ != target_state) {
-                executeOnExitActions(current_state_, event);
-                current_state_ = target_state;
-                executeOnEnterActions(current_state_, event);
+            auto target_it = table.states.find(target_state);
+            if (target_it == table.states.end()) {
+                throw FSMStateNotFoundError(describeState(target_state));
             }
-            
-            return true;
+            target = &target_it->second;
+            return &transition;
+        }
+    }
+    
+    return nullptr;
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+bool FSM<TEvent, TState, TContext, TLock>::processFrom(const StateTable& table, const StateData*& state_data, const TEvent& event) {
+    const std::shared_ptr<StateData>* target = nullptr;
+    const auto* transition = findTransition(table, *state_data, event, target);
+    if (!transition) {
+        return false;
+    }
+    
+    // Read before the actions run: an action that edits the state can move the transition
+    auto target_state = transition->getTargetState();
+    transition->executeActions(event);
+    
+    if (current_state_ != target_state) {
+        executeOnExitActions(*state_data, event);
+        current_state_ = target_state;
+        executeOnEnterActions(**target, event);
+        publishCurrentState(**target);
+    }
+    state_data = target->get();
+    
+    if (internal_head_ != internal_events_.size() && !completing_) {
+        runToCompletion(table, state_data);
+    }
+    return true;
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::runToCompletion(const StateTable& table, const StateData*& state_data) {
+    if (completing_) {
+        return; // The outer call drains the events queued here
+    }
+    completing_ = true;
+    try {
+        while (internal_head_ != internal_events_.size()) {
+            // Moved out first: processing it may post more events and grow the vector
+            TEvent event = std::move(internal_events_[internal_head_++]);
+            processFrom(table, state_data, event);
+        }
+    } catch (...) {
+        internal_events_.clear();
+        internal_head_ = 0;
+        completing_ = false;
+        throw;
+    }
+    internal_events_.clear(); // Keeps the capacity for the next run
+    internal_head_ = 0;
+    completing_ = false;
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::postInternal(const TEvent& event) {
+    postInternal(TEvent(event));
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::postInternal(TEvent&& event) {
+    if (action_timing_ == ActionTiming::AfterCommit) {
+        throw FSMInvalidStateError("postInternal() requires ActionTiming::UnderLock");
+    }
+    internal_events_.push_back(std::move(event));
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+bool FSM<TEvent, TState, TContext, TLock>::processAfterCommit(const TEvent& event) {
+    // The shared StateData keeps the transition and actions alive after the lock is
+    // released, even if an edit replaces the table in the meantime
+    std::shared_ptr<const StateData> source;
+    std::shared_ptr<const StateData> target;
+    const Transition<TEvent, TState, TContext>* transition = nullptr;
+#ifdef FSMGINE_MULTI_THREADED
+    std::uint64_t ticket = 0;
+#endif
+    {
+#ifdef FSMGINE_MULTI_THREADED
+        std::lock_guard<TLock> lock(mutex_);
+#endif
+        auto table = readTable();
+        
+        const auto& current = resolveCurrentState(*table);
+        const std::shared_ptr<StateData>* target_entry = nullptr;
+        transition = findTransition(*table, *current, event, target_entry);
+        if (!transition) {
+            return false;
+        }
+        
+        source = current;
+        auto target_state = transition->getTargetState();
+        if (current_state_ != target_state) {
+            target = *target_entry;
+            current_state_ = target_state;
+            publishCurrentState(*target);
         }
+#ifdef FSMGINE_MULTI_THREADED
+        ticket = next_ticket_++;
+#endif
     }
     
-    return false;
+#ifdef FSMGINE_MULTI_THREADED
+    ActionTurn turn(*this, ticket);
+#endif
+    transition->executeActions(event);
+    if (target) {
+        executeOnExitActions(*source, event);
+        executeOnEnterActions(*target, event);
+    }
+    return true;
 }
 
-template<typename TEvent>
-std::string_view FSM<TEvent>::getCurrentState() const {
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::setActionTiming(ActionTiming timing) {
 #ifdef FSMGINE_MULTI_THREADED
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::lock_guard<TLock> lock(mutex_);
+    waitForDeferredActions();
+#endif
+    action_timing_ = timing;
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::setFlatCombining(bool enabled) {
+#ifdef FSMGINE_MULTI_THREADED
+    std::lock_guard<TLock> lock(mutex_);
+    if (enabled && !combining_slots_) {
+        // Room for every hardware thread; callers beyond that process directly
+        combining_slot_count_ = std::max<std::size_t>(8, std::thread::hardware_concurrency());
+        combining_slots_ = std::make_unique<CombiningSlot[]>(combining_slot_count_);
+    }
 #endif
+    flat_combining_ = enabled;
+}
+
+#ifdef FSMGINE_MULTI_THREADED
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+FSM<TEvent, TState, TContext, TLock>::ActionTurn::ActionTurn(FSM& fsm, std::uint64_t ticket) : fsm_(fsm) {
+    std::unique_lock<std::mutex> lock(fsm_.turn_mutex_);
+    fsm_.turn_.wait(lock, [this, ticket] { return fsm_.actions_done_ == ticket; });
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+FSM<TEvent, TState, TContext, TLock>::ActionTurn::~ActionTurn() {
+    {
+        std::lock_guard<std::mutex> lock(fsm_.turn_mutex_);
+        ++fsm_.actions_done_;
+    }
+    fsm_.turn_.notify_all();
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::waitForDeferredActions() {
+    std::unique_lock<std::mutex> lock(turn_mutex_);
+    turn_.wait(lock, [this] { return actions_done_ == next_ticket_; });
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+bool FSM<TEvent, TState, TContext, TLock>::processCombined(const TEvent& event) {
+    // Uncontended: process directly, then serve anyone who parked an event meanwhile
+    if (mutex_.try_lock()) {
+        std::lock_guard<TLock> lock(mutex_, std::adopt_lock);
+        auto table = readTable();
+        const StateData* state_data = resolveCurrentState(*table).get();
+        const bool result = processFrom(*table, state_data, event);
+        combine(*table, state_data);
+        return result;
+    }
+    
+    // Each thread starts its search at its own slot, so it usually claims it at once
+    static std::atomic<std::size_t> next_hint{0};
+    thread_local const std::size_t hint = next_hint.fetch_add(1, std::memory_order_relaxed);
+    
+    CombiningSlot* slot = nullptr;
+    for (std::size_t i = 0; i < combining_slot_count_ && !slot; ++i) {
+        CombiningSlot& candidate = combining_slots_[(hint + i) % combining_slot_count_];
+        int expected = CombiningSlot::FREE;
+        if (candidate.state.compare_exchange_strong(expected, CombiningSlot::CLAIMED, std::memory_order_acquire)) {
+            slot = &candidate;
+        }
+    }
+    if (!slot) {
+        // More callers than slots: process directly
+        std::lock_guard<TLock> lock(mutex_);
+        auto table = readTable();
+        const StateData* state_data = resolveCurrentState(*table).get();
+        return processFrom(*table, state_data, event);
+    }
     
+    slot->event = &event;
+    combining_parked_.fetch_add(1, std::memory_order_relaxed);
+    slot->state.store(CombiningSlot::PENDING, std::memory_order_release);
+    while (slot->state.load(std::memory_order_acquire) != CombiningSlot::DONE) {
+        if (mutex_.try_lock()) {
+            std::lock_guard<TLock> lock(mutex_, std::adopt_lock);
+            combine(*readTable(), nullptr);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    
+    const bool result = slot->result;
+    std::exception_ptr error = std::move(slot->error);
+    slot->state.store(CombiningSlot::FREE, std::memory_order_release);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return result;
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::combine(const StateTable& table, const StateData* state_data) {
+    // A few passes pick up events parked while the first pass ran, without letting one
+    // combiner serve the others indefinitely
+    constexpr int MAX_PASSES = 4;
+    
+    for (int pass = 0; pass < MAX_PASSES; ++pass) {
+        if (combining_parked_.load(std::memory_order_relaxed) == 0) {
+            break; // A caller that parks after this check serves itself
+        }
+        bool served = false;
+        for (std::size_t i = 0; i < combining_slot_count_; ++i) {
+            CombiningSlot& slot = combining_slots_[i];
+            if (slot.state.load(std::memory_order_acquire) != CombiningSlot::PENDING) {
+                continue;
+            }
+            served = true;
+            try {
+                if (!state_data) {
+                    state_data = resolveCurrentState(table).get();
+                }
+                slot.result = processFrom(table, state_data, *slot.event);
+            } catch (...) {
+                slot.error = std::current_exception();
+                state_data = nullptr; // An action may have thrown mid-transition; resolve again
+            }
+            combining_parked_.fetch_sub(1, std::memory_order_relaxed);
+            slot.state.store(CombiningSlot::DONE, std::memory_order_release);
+        }
+        if (!served) {
+            break;
+        }
+    }
+}
+#endif
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+TState FSM<TEvent, TState, TContext, TLock>::getCurrentState() const {
+#ifdef FSMGINE_MULTI_THREADED
+    const TState* published = published_state_.load(std::memory_order_acquire);
+    if (published == nullptr) {
+        throw FSMNotInitializedError();
+    }
+    return *published;
+#else
     if (!has_initial_state_) {
         throw FSMNotInitializedError();
     }
     
     return current_state_;
+#endif
 }
 
-template<typename TEvent>
-void FSM<TEvent>::addTransition(std::string_view from_state, Transition<TEvent> transition) {
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::publishCurrentState([[maybe_unused]] const StateData& state_data) {
 #ifdef FSMGINE_MULTI_THREADED
-    std::unique_lock<std::mutex> lock(mutex_);
+    published_state_.store(state_data.published_name, std::memory_order_release);
 #endif
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+typename FSM<TEvent, TState, TContext, TLock>::TableReader FSM<TEvent, TState, TContext, TLock>::readTable() const {
+#ifdef FSMGINE_MULTI_THREADED
+    return table_.read(&emptyTable());
+#else
+    return table_ ? table_.get() : &emptyTable();
+#endif
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+const typename FSM<TEvent, TState, TContext, TLock>::StateTable& FSM<TEvent, TState, TContext, TLock>::emptyTable() {
+    static const StateTable empty(std::pmr::new_delete_resource());
+    return empty;
+}
+
+#ifdef FSMGINE_MULTI_THREADED
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::markStarted() {
+    if (!started_) {
+        std::lock_guard<std::recursive_mutex> edit_lock(edit_mutex_);
+        started_ = true;
+    }
+}
+#endif
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+const typename FSM<TEvent, TState, TContext, TLock>::StateTable& FSM<TEvent, TState, TContext, TLock>::editorTable() const {
+#ifdef FSMGINE_MULTI_THREADED
+    return table_.hasSnapshot() ? table_.current() : emptyTable();
+#else
+    return table_ ? *table_ : emptyTable();
+#endif
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::addTransition(TState from_state, Transition<TEvent, TState, TContext> transition) {
+    EditScope scope(*this);
+    auto& table = scope.table();
     
-    // Optimization 1: Cache StringInterner reference to avoid repeated singleton calls
-    auto& interner = StringInterner::instance();
-    auto interned_from_state = interner.intern(from_state);
-    auto& state_data = getOrCreateState(interned_from_state);
+    auto& state_data = editState(table, internState(from_state));
     
-    auto target_state = transition.getTargetState();
-    if (!target_state.empty()) {
-        auto interned_target_state = interner.intern(target_state);
-        getOrCreateState(interned_target_state);
+    if (transition.hasTargetState()) {
+        auto interned_target_state = internState(transition.getTargetState());
+        if (table.states.find(interned_target_state) == table.states.end()) {
+            editState(table, interned_target_state);
+        }
     }
     
     state_data.transitions.push_back(std::move(transition));
+    scope.commit();
 }
 
-template<typename TEvent>
-void FSM<TEvent>::addOnEnterAction(std::string_view state, Action action) {
-#ifdef FSMGINE_MULTI_THREADED
-    std::unique_lock<std::mutex> lock(mutex_);
-#endif
-    
-    // Optimization 1: Cache StringInterner reference
-    auto& interner = StringInterner::instance();
-    auto interned_state = interner.intern(state);
-    auto& state_data = getOrCreateState(interned_state);
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::addOnEnterAction(TState state, Action action) {
+    EditScope scope(*this);
+    auto& state_data = editState(scope.table(), internState(state));
     
     if (action) {
         state_data.on_enter_actions.push_back(std::move(action));
     }
+    scope.commit();
 }
 
-template<typename TEvent>
-void FSM<TEvent>::addOnExitAction(std::string_view state, Action action) {
-#ifdef FSMGINE_MULTI_THREADED
-    std::unique_lock<std::mutex> lock(mutex_);
-#endif
-    
-    // Optimization 1: Cache StringInterner reference
-    auto& interner = StringInterner::instance();
-    auto interned_state = interner.intern(state);
-    auto& state_data = getOrCreateState(interned_state);
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::addOnExitAction(TState state, Action action) {
+    EditScope scope(*this);
+    auto& state_data = editState(scope.table(), internState(state));
     
     if (action) {
         state_data.on_exit_actions.push_back(std::move(action));
     }
+    scope.commit();
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::setKeyExtractor(KeyExtractor extractor) {
+    EditScope scope(*this);
+    scope.table().key_extractor = std::move(extractor);
+    scope.commit();
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+typename FSM<TEvent, TState, TContext, TLock>::KeyExtractor FSM<TEvent, TState, TContext, TLock>::defaultKeyExtractor() {
+    if constexpr (std::is_enum_v<TEvent> || std::is_integral_v<TEvent>) {
+        return [](const TEvent& event) { return toEventKey(event); };
+    } else if constexpr (is_variant_event_v<TEvent>) {
+        return [](const TEvent& event) { return toEventKey(event.index()); };
+    } else {
+        return nullptr;
+    }
 }
 
-template<typename TEvent>
-typename FSM<TEvent>::StateData& FSM<TEvent>::getOrCreateState(std::string_view state) {
-    auto it = states_.find(state);
-    if (it == states_.end()) {
-        auto [inserted_it, success] = states_.emplace(state, StateData{});
-        return inserted_it->second;
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+TState FSM<TEvent, TState, TContext, TLock>::internState(TState state) {
+    if constexpr (is_named_state_v<TState>) {
+        return StringInterner::instance().intern(state);
+    } else {
+        return state;
     }
-    return it->second;
 }
 
-template<typename TEvent>
-void FSM<TEvent>::executeOnExitActions(std::string_view state, const TEvent& event) const {
-    auto it = states_.find(state);
-    if (it != states_.end()) {
-        for (const auto& action : it->second.on_exit_actions) {
-            action(event);
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+typename FSM<TEvent, TState, TContext, TLock>::StateData& FSM<TEvent, TState, TContext, TLock>::editState(StateTable& table, TState state) {
+    std::pmr::polymorphic_allocator<StateData> allocator(table.resource());
+    auto& entry = table.states[state];
+    if (!entry) {
+        entry = std::allocate_shared<StateData>(allocator, table.resource());
+#ifdef FSMGINE_MULTI_THREADED
+        if constexpr (is_named_state_v<TState>) {
+            entry->published_name = &*state_names_.insert(state).first;
+        } else {
+            entry->published_name = EnumStates::stableValue(state);
         }
+#endif
+    } else if (entry.use_count() > 1) {
+        // Still referenced by a published table, which must stay immutable
+        entry = std::allocate_shared<StateData>(allocator, *entry, table.resource());
     }
+    return *entry;
 }
 
-template<typename TEvent>
-void FSM<TEvent>::executeOnEnterActions(std::string_view state, const TEvent& event) const {
-    auto it = states_.find(state);
-    if (it != states_.end()) {
-        for (const auto& action : it->second.on_enter_actions) {
-            action(event);
-        }
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::executeOnExitActions(const StateData& state_data, const TEvent& event) const {
+    for (const auto& action : state_data.on_exit_actions) {
+        action(event);
+    }
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void FSM<TEvent, TState, TContext, TLock>::executeOnEnterActions(const StateData& state_data, const TEvent& event) const {
+    for (const auto& action : state_data.on_enter_actions) {
+        action(event);
     }
 }
 
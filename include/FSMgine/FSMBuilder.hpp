@@ -17,6 +17,8 @@ namespace fsmgine {
 
 /// @brief Builder for creating transitions with a fluent interface
 /// @tparam TEvent The event type used for transitions
+/// @tparam TState The FSM's state type (see FSM)
+/// @tparam TContext The FSM's context type (see FSM)
 /// @ingroup builder
 /// 
 /// @details TransitionBuilder provides a fluent API for defining transitions
@@ -33,19 +35,25 @@ namespace fsmgine {
 ///    .action([](const Event& e) { std::cout << "Transitioning!"; })
 ///    .to("StateB");
 /// @endcode
-template<typename TEvent>
+template<typename TEvent, typename TState, typename TContext, typename TLock>
 class TransitionBuilder {
 public:
     /// @brief Type alias for transition guard predicates
-    using Predicate = typename FSM<TEvent>::Predicate;
+    using Predicate = typename FSM<TEvent, TState, TContext, TLock>::Predicate;
     
     /// @brief Type alias for transition actions
-    using Action = typename FSM<TEvent>::Action;
+    using Action = typename FSM<TEvent, TState, TContext, TLock>::Action;
+    
+    /// @brief Type alias for span actions of byte-event transitions
+    using SpanAction = typename Transition<TEvent, TState, TContext>::SpanAction;
+    
+    /// @brief Parameter type naming a state: a string for named states, else the enum
+    using StateParam = std::conditional_t<is_named_state_v<TState>, const std::string&, TState>;
 
     /// @brief Constructs a transition builder for a specific source state
     /// @param fsm The FSM this transition belongs to
     /// @param from_state The source state for this transition
-    explicit TransitionBuilder(FSM<TEvent>& fsm, std::string_view from_state);
+    explicit TransitionBuilder(FSM<TEvent, TState, TContext, TLock>& fsm, TState from_state);
     
     TransitionBuilder(const TransitionBuilder&) = delete;
     TransitionBuilder& operator=(const TransitionBuilder&) = delete;
@@ -62,25 +70,119 @@ public:
     /// @note Multiple predicates can be added; all must pass for the transition to occur
     TransitionBuilder& predicate(Predicate pred);
     
+    /// @brief Adds a predicate written for one alternative of a std::variant event
+    /// @tparam F Callable taking exactly one of the variant's alternatives
+    /// @param pred A function receiving the unwrapped alternative
+    /// @return Reference to this builder for method chaining
+    /// @note Events holding another alternative fail the predicate; declare the
+    ///       transition with on<Alternative>() so they never reach it
+    /// @note Not available in context mode
+    template<typename F, typename TAlternative = typename AcceptedAlternative<F, TEvent>::type>
+    TransitionBuilder& predicate(F pred) {
+        static_assert(std::is_void_v<TContext>, "Unwrapping guards capture the callable; context-mode guards must take the event");
+        return predicate([pred = std::move(pred)](const TEvent& event) {
+            const TAlternative* alternative = std::get_if<TAlternative>(&event);
+            return alternative && static_cast<bool>(pred(*alternative));
+        });
+    }
+    
     /// @brief Adds an action to execute during the transition
     /// @param action A function to execute when this transition occurs
     /// @return Reference to this builder for method chaining
     /// @note Multiple actions can be added; they execute in the order added
     TransitionBuilder& action(Action action);
     
+    /// @brief Adds an action written for one alternative of a std::variant event
+    /// @tparam F Callable taking exactly one of the variant's alternatives
+    /// @param action A function receiving the unwrapped alternative
+    /// @return Reference to this builder for method chaining
+    /// @note The action is skipped for events holding another alternative
+    /// @note Not available in context mode
+    template<typename F, typename TAlternative = typename AcceptedAlternative<F, TEvent>::type>
+    TransitionBuilder& action(F action) {
+        static_assert(std::is_void_v<TContext>, "Unwrapping actions capture the callable; context-mode actions must take the event");
+        return this->action([action = std::move(action)](const TEvent& event) {
+            if (const TAlternative* alternative = std::get_if<TAlternative>(&event)) {
+                action(*alternative);
+            }
+        });
+    }
+    
+    /// @brief Adds an action that receives the consumed input as a span
+    /// @param action A function taking the consumed bytes as `std::string_view`
+    /// @return Reference to this builder for method chaining
+    /// @note Only available for byte events (char, signed char, unsigned char)
+    /// @note Span actions run after regular actions. On a class-guarded self-loop
+    ///       without predicates or regular actions, FSMInstance::processBytes() skips the
+    ///       whole run with a vectorized scan and calls the action once for all of it
+    TransitionBuilder& spanAction(SpanAction action);
+    
+    /// @brief Dispatches the transition under an event key
+    /// @tparam TKey An enum or integral type
+    /// @param key The key; the transition is only considered for events the FSM's key
+    ///            extractor maps to this key (see FSMBuilder::keyedBy())
+    /// @return Reference to this builder for method chaining
+    /// @note Keyed transitions are found through a jump table once the FSM is compiled,
+    ///       so dispatch cost does not grow with the number of outgoing transitions
+    /// @note Predicates still apply on top of the key; calling on() again replaces the key
+    template<typename TKey>
+    TransitionBuilder& on(TKey key) {
+        transition_.setKey(toEventKey(key));
+        return *this;
+    }
+    
+    /// @brief Dispatches the transition under one alternative of a std::variant event
+    /// @tparam TAlternative The alternative; must occur exactly once in TEvent
+    /// @return Reference to this builder for method chaining
+    /// @details Keys the transition by the alternative's index, which is what the default
+    /// key extractor of variant events returns. Events holding other alternatives skip the
+    /// transition without running its predicates; guards and actions taking TAlternative
+    /// receive the unwrapped value.
+    /// @note Requires the default key extractor; do not combine with FSMBuilder::keyedBy()
+    template<typename TAlternative>
+    TransitionBuilder& on() {
+        static_assert(is_variant_event_v<TEvent>, "on<Alternative>() requires a std::variant event type");
+        transition_.setKey(toEventKey(variant_index_v<TAlternative, TEvent>));
+        return *this;
+    }
+    
+    /// @brief Restricts the transition to bytes in a character class
+    /// @param spec Characters and ranges, e.g. `"0-9a-zA-Z"` (see CharClass::parse())
+    /// @return Reference to this builder for method chaining
+    /// @throws std::invalid_argument if the specification is malformed
+    /// @note Only available for byte events (char, signed char, unsigned char)
+    /// @note Unlike predicate(), the class is visible to the compiler, which turns each
+    ///       state of a compiled byte machine into a 256-entry lookup table
+    TransitionBuilder& onChars(std::string_view spec);
+    
+    /// @brief Restricts the transition to every byte except one
+    /// @param c The excluded byte
+    /// @return Reference to this builder for method chaining
+    /// @note Only available for byte events (char, signed char, unsigned char)
+    TransitionBuilder& onAnyExcept(char c);
+    
+    /// @brief Restricts the transition to every byte outside a character class
+    /// @param spec Excluded characters and ranges (see CharClass::parse())
+    /// @return Reference to this builder for method chaining
+    /// @throws std::invalid_argument if the specification is malformed
+    /// @note Only available for byte events (char, signed char, unsigned char)
+    TransitionBuilder& onAnyExcept(std::string_view spec);
+    
     /// @brief Completes the transition by specifying the target state
     /// @param state The target state for this transition
     /// @note This method finalizes and adds the transition to the FSM
-    void to(const std::string& state);
+    void to(StateParam state);
     
 private:
-    FSM<TEvent>& fsm_;
-    std::string_view from_state_;
-    Transition<TEvent> transition_;
+    FSM<TEvent, TState, TContext, TLock>& fsm_;
+    TState from_state_;
+    Transition<TEvent, TState, TContext> transition_;
 };
 
 /// @brief Main builder class for constructing FSMs with a fluent interface
 /// @tparam TEvent The event type used for transitions
+/// @tparam TState The FSM's state type (see FSM)
+/// @tparam TContext The FSM's context type (see FSM)
 /// @ingroup builder
 /// 
 /// @details FSMBuilder provides a fluent API for constructing finite state machines.
@@ -108,15 +210,18 @@ private:
 /// 
 /// fsm.setInitialState("Idle");
 /// @endcode
-template<typename TEvent>
+template<typename TEvent, typename TState, typename TContext, typename TLock>
 class FSMBuilder {
 public:
     /// @brief Type alias for state actions
-    using Action = typename FSM<TEvent>::Action;
+    using Action = typename FSM<TEvent, TState, TContext, TLock>::Action;
+    
+    /// @brief Parameter type naming a state: a string for named states, else the enum
+    using StateParam = typename TransitionBuilder<TEvent, TState, TContext, TLock>::StateParam;
 
     /// @brief Constructs a builder for the given FSM
     /// @param fsm The FSM to build
-    explicit FSMBuilder(FSM<TEvent>& fsm);
+    explicit FSMBuilder(FSM<TEvent, TState, TContext, TLock>& fsm);
     
     FSMBuilder(const FSMBuilder&) = delete;
     FSMBuilder& operator=(const FSMBuilder&) = delete;
@@ -130,81 +235,112 @@ public:
     /// @brief Starts building a transition from the specified state
     /// @param state The source state for the transition
     /// @return A TransitionBuilder for defining the transition details
-    TransitionBuilder<TEvent> from(const std::string& state);
+    TransitionBuilder<TEvent, TState, TContext, TLock> from(StateParam state);
     
     /// @brief Adds an action to execute when entering a state
     /// @param state The state to add the action to
     /// @param action The action to execute when entering the state
     /// @return Reference to this builder for method chaining
-    FSMBuilder& onEnter(const std::string& state, Action action);
+    FSMBuilder& onEnter(StateParam state, Action action);
     
     /// @brief Adds an action to execute when exiting a state
     /// @param state The state to add the action to
     /// @param action The action to execute when exiting the state
     /// @return Reference to this builder for method chaining
-    FSMBuilder& onExit(const std::string& state, Action action);
+    FSMBuilder& onExit(StateParam state, Action action);
+    
+    /// @brief Sets the function that maps events to the keys used by TransitionBuilder::on()
+    /// @tparam TExtractor Callable taking `const TEvent&` and returning an enum or integral key
+    /// @param extractor The key extractor; replaces any extractor set before
+    /// @return Reference to this builder for method chaining
+    /// @note Enum and integral event types use the event itself as key by default
+    /// @par Example
+    /// @code{.cpp}
+    /// fsm.get_builder()
+    ///     .keyedBy([](const Message& m) { return m.type; })
+    ///     .from("Running").on(MessageType::Stop).to("Idle");
+    /// @endcode
+    template<typename TExtractor>
+    FSMBuilder& keyedBy(TExtractor extractor) {
+        fsm_.setKeyExtractor([extractor = std::move(extractor)](const TEvent& event) {
+            return toEventKey(extractor(event));
+        });
+        return *this;
+    }
     
 private:
-    FSM<TEvent>& fsm_;
+    FSM<TEvent, TState, TContext, TLock>& fsm_;
 };
 
 // --- Implementation ---
 
 // TransitionBuilder
-template<typename TEvent>
-TransitionBuilder<TEvent>::TransitionBuilder(FSM<TEvent>& fsm, std::string_view from_state)
-    : fsm_(fsm), from_state_(from_state) {
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+TransitionBuilder<TEvent, TState, TContext, TLock>::TransitionBuilder(FSM<TEvent, TState, TContext, TLock>& fsm, TState from_state)
+    : fsm_(fsm), from_state_(from_state), transition_(fsm.resource_) {
 }
 
-template<typename TEvent>
-TransitionBuilder<TEvent>& TransitionBuilder<TEvent>::predicate(Predicate pred) {
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+TransitionBuilder<TEvent, TState, TContext, TLock>& TransitionBuilder<TEvent, TState, TContext, TLock>::predicate(Predicate pred) {
     transition_.addPredicate(std::move(pred));
     return *this;
 }
 
-template<typename TEvent>
-TransitionBuilder<TEvent>& TransitionBuilder<TEvent>::action(Action action) {
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+TransitionBuilder<TEvent, TState, TContext, TLock>& TransitionBuilder<TEvent, TState, TContext, TLock>::action(Action action) {
     transition_.addAction(std::move(action));
     return *this;
 }
 
-template<typename TEvent>
-void TransitionBuilder<TEvent>::to(const std::string& state) {
-    // Optimization: Cache StringInterner reference
-    auto& interner = StringInterner::instance();
-    auto interned_state = interner.intern(state);
-    transition_.setTargetState(interned_state);
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+TransitionBuilder<TEvent, TState, TContext, TLock>& TransitionBuilder<TEvent, TState, TContext, TLock>::spanAction(SpanAction action) {
+    transition_.addSpanAction(std::move(action));
+    return *this;
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+TransitionBuilder<TEvent, TState, TContext, TLock>& TransitionBuilder<TEvent, TState, TContext, TLock>::onChars(std::string_view spec) {
+    transition_.setCharClass(CharClass::parse(spec));
+    return *this;
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+TransitionBuilder<TEvent, TState, TContext, TLock>& TransitionBuilder<TEvent, TState, TContext, TLock>::onAnyExcept(char c) {
+    transition_.setCharClass(CharClass::single(static_cast<unsigned char>(c)).complement());
+    return *this;
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+TransitionBuilder<TEvent, TState, TContext, TLock>& TransitionBuilder<TEvent, TState, TContext, TLock>::onAnyExcept(std::string_view spec) {
+    transition_.setCharClass(CharClass::parse(spec).complement());
+    return *this;
+}
+
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+void TransitionBuilder<TEvent, TState, TContext, TLock>::to(StateParam state) {
+    transition_.setTargetState(FSM<TEvent, TState, TContext, TLock>::internState(state));
     fsm_.addTransition(from_state_, std::move(transition_));
 }
 
 // FSMBuilder
-template<typename TEvent>
-FSMBuilder<TEvent>::FSMBuilder(FSM<TEvent>& fsm) : fsm_(fsm) {
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+FSMBuilder<TEvent, TState, TContext, TLock>::FSMBuilder(FSM<TEvent, TState, TContext, TLock>& fsm) : fsm_(fsm) {
 }
 
-template<typename TEvent>
-TransitionBuilder<TEvent> FSMBuilder<TEvent>::from(const std::string& state) {
-    // Optimization: Cache StringInterner reference
-    auto& interner = StringInterner::instance();
-    auto interned_state = interner.intern(state);
-    return TransitionBuilder<TEvent>(fsm_, interned_state);
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+TransitionBuilder<TEvent, TState, TContext, TLock> FSMBuilder<TEvent, TState, TContext, TLock>::from(StateParam state) {
+    return TransitionBuilder<TEvent, TState, TContext, TLock>(fsm_, FSM<TEvent, TState, TContext, TLock>::internState(state));
 }
 
-template<typename TEvent>
-FSMBuilder<TEvent>& FSMBuilder<TEvent>::onEnter(const std::string& state, Action action) {
-    // Optimization: Cache StringInterner reference
-    auto& interner = StringInterner::instance();
-    auto interned_state = interner.intern(state);
-    fsm_.addOnEnterAction(interned_state, std::move(action));
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+FSMBuilder<TEvent, TState, TContext, TLock>& FSMBuilder<TEvent, TState, TContext, TLock>::onEnter(StateParam state, Action action) {
+    fsm_.addOnEnterAction(FSM<TEvent, TState, TContext, TLock>::internState(state), std::move(action));
     return *this;
 }
 
-template<typename TEvent>
-FSMBuilder<TEvent>& FSMBuilder<TEvent>::onExit(const std::string& state, Action action) {
-    // Optimization: Cache StringInterner reference
-    auto& interner = StringInterner::instance();
-    auto interned_state = interner.intern(state);
-    fsm_.addOnExitAction(interned_state, std::move(action));
+template<typename TEvent, typename TState, typename TContext, typename TLock>
+FSMBuilder<TEvent, TState, TContext, TLock>& FSMBuilder<TEvent, TState, TContext, TLock>::onExit(StateParam state, Action action) {
+    fsm_.addOnExitAction(FSM<TEvent, TState, TContext, TLock>::internState(state), std::move(action));
     return *this;
 }
 
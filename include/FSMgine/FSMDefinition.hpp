@@ -0,0 +1,667 @@
+/// @file FSMDefinition.hpp
+/// @brief Immutable, shareable compiled topology of a finite state machine
+/// @ingroup core
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <variant> // For std::monostate
+#include "FSMgine/ByteScanner.hpp"
+#include "FSMgine/CharClass.hpp"
+#include "FSMgine/FSM.hpp"
+
+namespace fsmgine {
+
+/// @brief Dense integer identifier of a state inside a compiled machine
+/// @ingroup core
+using StateId = std::uint32_t;
+
+/// @brief Sentinel StateId meaning "no state"
+/// @ingroup core
+inline constexpr StateId INVALID_STATE_ID = std::numeric_limits<StateId>::max();
+
+/// @brief Placeholder context of definitions whose guards and actions take none
+/// @ingroup core
+struct NoContext {};
+
+/// @brief The frozen states, transitions and actions of an FSM, addressed by StateId
+/// @tparam TEvent The event type used for transitions (defaults to std::monostate for event-less FSMs)
+/// @tparam TContext The context guards and actions receive, or void (see FSM)
+/// @ingroup core
+///
+/// @details An FSMDefinition is produced by FSM::compileDefinition(). All states are
+/// stored in a contiguous vector and every transition holds the resolved StateId of
+/// its target, so stepping performs no hashing and no string comparisons.
+///
+/// A definition holds no runtime cursor. It is built once, handed out as a
+/// `std::shared_ptr<const FSMDefinition>`, and driven by any number of FSMInstance
+/// objects that each store only their current StateId.
+///
+/// @par Keyed Dispatch
+/// States with transitions declared through TransitionBuilder::on() get a jump table
+/// from EventKey to the candidate transitions for that key (keyed transitions with a
+/// matching key plus all unkeyed transitions, in definition order). Dense key ranges
+/// use an array; spread-out keys use a hash table. The event key is extracted once
+/// per process() call, so dispatch cost is independent of the state's fan-out.
+///
+/// @par Byte Tables
+/// For byte events (char, signed char, unsigned char) every state without keyed
+/// transitions is compiled into a 256-entry table mapping the input byte to the first
+/// transition whose character class admits it. When that transition has no opaque
+/// predicates, process() is a single table load followed by the transition itself.
+///
+/// @par Run Skipping
+/// A byte state may have a "run" transition: a class-guarded self-loop with no
+/// predicates, no key and no regular actions (span actions are allowed). processBytes()
+/// skips a whole run of such bytes with one ByteScanner search for the first byte that
+/// leaves the loop and then calls each span action once with the entire run.
+///
+/// @par Memory Layout
+/// Transitions of all states are stored structure-of-arrays style in a few flat arrays
+/// indexed by a global transition index: guard ranges, target ids, character classes and
+/// action ranges, with the guards and actions themselves in shared callable arrays. Each
+/// state holds only the [begin, end) range of its transitions and its dispatch tables, so
+/// scanning the guards of the current state walks contiguous memory. Names and on-enter
+/// and on-exit action ranges live in a separate array that stepping touches only when the
+/// state changes.
+///
+/// @par Context Mode
+/// When compiled from an FSM with a TContext, guards and actions are stored as plain
+/// function pointers and receive the context passed to process(), changeState() and
+/// processBytes(); instances pass the context they were bound to. The definition then
+/// contains no captured state at all, and every call is a direct call the compiler can
+/// see through when the callee is known.
+///
+/// @par Thread Safety
+/// A definition is immutable after construction and may be shared read-only across
+/// threads. Actions run by process() are invoked on the calling thread; they must be
+/// safe to call concurrently if several threads drive instances of one definition.
+template<typename TEvent = std::monostate, typename TContext>
+class FSMDefinition {
+public:
+    /// @brief The context type instances bind; NoContext when guards and actions take none
+    using Context = std::conditional_t<std::is_void_v<TContext>, NoContext, TContext>;
+
+    /// @brief Type alias for transition predicates
+    using Predicate = typename FSM<TEvent, std::string_view, TContext>::Predicate;
+
+    /// @brief Type alias for transition and state actions
+    using Action = typename FSM<TEvent, std::string_view, TContext>::Action;
+
+    /// @brief Type alias for event key extractors
+    using KeyExtractor = typename FSM<TEvent, std::string_view, TContext>::KeyExtractor;
+
+    /// @brief Type alias for span actions of byte-event transitions
+    using SpanAction = typename Transition<TEvent, std::string_view, TContext>::SpanAction;
+
+
+private:
+    // Character classes only exist for byte events
+    struct NoCharClass {};
+    using CharClassStorage = std::conditional_t<is_byte_event_v<TEvent>, CharClass, NoCharClass>;
+
+    // Byte -> offset, within the state's transitions, of the first admitting one, or NO_TRANSITION
+    using ByteTable = std::array<std::uint16_t, 256>;
+    static constexpr std::uint16_t NO_TRANSITION = std::numeric_limits<std::uint16_t>::max();
+
+    // [begin, end) range of indices into one of the flat arrays
+    struct IndexRange {
+        std::uint32_t begin = 0;
+        std::uint32_t end = 0;
+    };
+
+    // Self-loop that processBytes() consumes in bulk
+    struct ByteRun {
+        std::uint32_t transition = 0;
+        ByteScanner exit_scanner; // Finds the first byte that leaves the loop
+    };
+
+    // Jump table from event key to the candidate transitions of one state
+    struct KeyDispatch {
+        static constexpr std::uint32_t NO_SLOT = std::numeric_limits<std::uint32_t>::max();
+
+        EventKey min_key = 0;
+        std::vector<std::uint32_t> dense_slots;                   // key - min_key -> slot
+        std::unordered_map<EventKey, std::uint32_t> sparse_slots; // used when keys are spread out
+        std::vector<IndexRange> slots;                            // last slot holds unkeyed transitions
+        std::vector<std::uint32_t> candidates;                    // transition indices, definition order
+
+        IndexRange lookup(EventKey key) const;
+    };
+
+    // Per-state data consulted on every event
+    struct StateRoute {
+        IndexRange transitions;                // into the per-transition arrays
+        std::unique_ptr<KeyDispatch> dispatch; // null when no transition is keyed
+        std::unique_ptr<ByteTable> byte_table; // byte events only, null when dispatch is set
+        std::unique_ptr<ByteRun> byte_run;     // byte events only, null without a run transition
+    };
+
+    // Per-state data needed only for lookups and state changes
+    struct StateInfo {
+        std::string_view name;
+        IndexRange on_enter_actions; // into actions_
+        IndexRange on_exit_actions;  // into actions_
+    };
+
+public:
+    /// @brief Compiles a snapshot of the given FSM
+    /// @param fsm The FSM whose states, transitions and actions are copied
+    /// @throws FSMInvalidStateError if a transition has no target state
+    template<typename TLock>
+    explicit FSMDefinition(const FSM<TEvent, std::string_view, TContext, TLock>& fsm);
+
+    FSMDefinition(const FSMDefinition&) = delete;
+    FSMDefinition& operator=(const FSMDefinition&) = delete;
+
+    /// @brief Looks up the id of a state by name
+    /// @param state The state name
+    /// @return The StateId, or INVALID_STATE_ID if the state doesn't exist
+    StateId findState(std::string_view state) const;
+
+    /// @brief Looks up the id of a state by name, throwing if it is missing
+    /// @param state The state name
+    /// @param error_prefix Message prefix for the exception
+    /// @return The StateId
+    /// @throws FSMInvalidStateError if the state doesn't exist
+    StateId requireState(std::string_view state, const char* error_prefix) const;
+
+    /// @brief Gets the name of a state by id
+    /// @param id A StateId obtained from this definition
+    /// @return The state name
+    /// @throws FSMStateNotFoundError if the id is out of range
+    std::string_view getStateName(StateId id) const;
+
+    /// @brief Gets the number of states in the definition
+    /// @return The state count; valid ids are [0, getStateCount())
+    std::size_t getStateCount() const { return states_.size(); }
+
+    /// @brief Gets the number of transitions across all states
+    /// @return The transition count
+    std::size_t getTransitionCount() const { return targets_.size(); }
+
+    /// @brief Processes an event against an external cursor
+    /// @param current The cursor to advance; must be a valid StateId of this definition
+    /// @param event The event to process
+    /// @return true if a transition occurred, false otherwise
+    /// @note Runs transition actions, then on-exit/on-enter actions if the state changes
+    /// @note Only available without a context
+    bool process(StateId& current, const TEvent& event) const;
+
+    /// @brief Processes an event against an external cursor and context
+    /// @param current The cursor to advance; must be a valid StateId of this definition
+    /// @param context The context passed to guards and actions
+    /// @param event The event to process
+    /// @return true if a transition occurred, false otherwise
+    bool process(StateId& current, Context& context, const TEvent& event) const;
+
+    /// @brief Forces an external cursor into a state, running exit and enter actions
+    /// @param current The cursor to change; INVALID_STATE_ID skips the on-exit actions
+    /// @param target A valid StateId of this definition
+    /// @param event The event passed to the actions
+    /// @note On-exit actions are skipped when current already equals target
+    /// @note Only available without a context
+    void changeState(StateId& current, StateId target, const TEvent& event) const;
+
+    /// @brief Forces an external cursor into a state with a context
+    /// @param current The cursor to change; INVALID_STATE_ID skips the on-exit actions
+    /// @param target A valid StateId of this definition
+    /// @param context The context passed to the actions
+    /// @param event The event passed to the actions
+    void changeState(StateId& current, StateId target, Context& context, const TEvent& event) const;
+
+    /// @brief Processes a buffer of bytes against an external cursor
+    /// @param current The cursor to advance; must be a valid StateId of this definition
+    /// @param input The bytes to process, in order
+    /// @return The number of bytes consumed; processing stops before the first byte
+    ///         for which no transition exists
+    /// @note Only available for byte events (char, signed char, unsigned char)
+    /// @note Runs of a state's run transition are consumed by one vectorized scan and
+    ///       delivered to its span actions as a single view
+    /// @note Only available without a context
+    std::size_t processBytes(StateId& current, std::string_view input) const;
+
+    /// @brief Processes a buffer of bytes against an external cursor and context
+    /// @param current The cursor to advance; must be a valid StateId of this definition
+    /// @param context The context passed to guards and actions
+    /// @param input The bytes to process, in order
+    /// @return The number of bytes consumed, as for processBytes(StateId&, std::string_view)
+    std::size_t processBytes(StateId& current, Context& context, std::string_view input) const;
+
+private:
+    // Hot: read for every event
+    std::vector<StateRoute> states_;
+    std::vector<IndexRange> guard_ranges_;        // per transition, into guards_
+    std::vector<CharClassStorage> char_classes_;  // per transition; empty unless byte events
+    std::vector<Predicate> guards_;
+
+    // Warm: read when a transition is taken
+    std::vector<StateId> targets_;                // per transition
+    std::vector<IndexRange> action_ranges_;       // per transition, into actions_
+    std::vector<IndexRange> span_action_ranges_;  // per transition, into span_actions_; byte events only
+    std::vector<Action> actions_;                 // transition, on-enter and on-exit actions
+    std::vector<SpanAction> span_actions_;
+
+    // Cold: names and state-change actions
+    std::vector<StateInfo> state_info_;
+    std::unordered_map<std::string_view, StateId> state_ids_;
+    KeyExtractor key_extractor_;
+
+    // Helper methods
+    template<typename T, typename Source>
+    static IndexRange appendRange(std::vector<T>& dest, const Source& source);
+    static std::unique_ptr<KeyDispatch> buildKeyDispatch(const std::pmr::vector<Transition<TEvent, std::string_view, TContext>>& transitions,
+                                                         std::uint32_t first);
+    std::unique_ptr<ByteTable> buildByteTable(IndexRange transitions) const;
+    std::unique_ptr<ByteRun> buildByteRun(StateId state, IndexRange transitions, const ByteTable& table) const;
+    void takeTransition(StateId& current, std::uint32_t transition, Context& context, const TEvent& event) const;
+    bool predicatesPass(std::uint32_t transition, Context& context, const TEvent& event) const;
+    void runActions(IndexRange actions, Context& context, const TEvent& event) const;
+    void runTransitionActions(std::uint32_t transition, Context& context, const TEvent& event) const;
+
+    // Calls a guard or action, passing the context first in context mode
+    template<typename F, typename Arg>
+    static decltype(auto) call(const F& function, Context& context, const Arg& arg);
+};
+
+// --- Implementation ---
+
+template<typename TEvent, typename TContext>
+template<typename TLock>
+FSMDefinition<TEvent, TContext>::FSMDefinition(const FSM<TEvent, std::string_view, TContext, TLock>& fsm) {
+#ifdef FSMGINE_MULTI_THREADED
+    // Holding the edit lock keeps the table alive without stalling event processing
+    std::lock_guard<std::recursive_mutex> lock(fsm.edit_mutex_);
+#endif
+    const auto& table = fsm.editorTable();
+
+    // First pass: assign a dense id to every state so targets can be resolved
+    states_.resize(table.states.size());
+    state_info_.reserve(table.states.size());
+    state_ids_.reserve(table.states.size());
+    for (const auto& [name, state_data] : table.states) {
+        state_ids_.emplace(name, static_cast<StateId>(state_info_.size()));
+        StateInfo info;
+        info.name = name;
+        info.on_enter_actions = appendRange(actions_, state_data->on_enter_actions);
+        info.on_exit_actions = appendRange(actions_, state_data->on_exit_actions);
+        state_info_.push_back(info);
+    }
+
+    // Second pass: lay out each state's transitions contiguously, with resolved targets
+    for (const auto& [name, state_data] : table.states) {
+        const StateId id = state_ids_.find(name)->second;
+        auto& route = states_[id];
+        route.transitions.begin = static_cast<std::uint32_t>(targets_.size());
+        for (const auto& transition : state_data->transitions) {
+            auto target_it = state_ids_.find(transition.getTargetState());
+            if (target_it == state_ids_.end()) {
+                throw FSMInvalidStateError("Transition has no target state");
+            }
+            targets_.push_back(target_it->second);
+            guard_ranges_.push_back(appendRange(guards_, transition.getPredicates()));
+            action_ranges_.push_back(appendRange(actions_, transition.getActions()));
+            if constexpr (is_byte_event_v<TEvent>) {
+                char_classes_.push_back(transition.getCharClass());
+                span_action_ranges_.push_back(appendRange(span_actions_, transition.getSpanActions()));
+            }
+        }
+        route.transitions.end = static_cast<std::uint32_t>(targets_.size());
+
+        route.dispatch = buildKeyDispatch(state_data->transitions, route.transitions.begin);
+        if (route.dispatch && !table.key_extractor) {
+            throw FSMInvalidStateError("Keyed transition requires a key extractor");
+        }
+        if constexpr (is_byte_event_v<TEvent>) {
+            if (!route.dispatch) {
+                route.byte_table = buildByteTable(route.transitions);
+            }
+            if (route.byte_table) {
+                route.byte_run = buildByteRun(id, route.transitions, *route.byte_table);
+            }
+        }
+    }
+
+    key_extractor_ = table.key_extractor;
+}
+
+template<typename TEvent, typename TContext>
+StateId FSMDefinition<TEvent, TContext>::findState(std::string_view state) const {
+    auto it = state_ids_.find(state);
+    return it == state_ids_.end() ? INVALID_STATE_ID : it->second;
+}
+
+template<typename TEvent, typename TContext>
+StateId FSMDefinition<TEvent, TContext>::requireState(std::string_view state, const char* error_prefix) const {
+    StateId id = findState(state);
+    if (id == INVALID_STATE_ID) {
+        std::string error_msg(error_prefix);
+        error_msg.append(state);
+        throw FSMInvalidStateError(error_msg);
+    }
+    return id;
+}
+
+template<typename TEvent, typename TContext>
+std::string_view FSMDefinition<TEvent, TContext>::getStateName(StateId id) const {
+    if (id >= state_info_.size()) {
+        throw FSMStateNotFoundError("#" + std::to_string(id));
+    }
+    return state_info_[id].name;
+}
+
+template<typename TEvent, typename TContext>
+bool FSMDefinition<TEvent, TContext>::process(StateId& current, const TEvent& event) const {
+    static_assert(std::is_void_v<TContext>, "This definition's guards and actions need a context");
+    NoContext none;
+    return process(current, none, event);
+}
+
+template<typename TEvent, typename TContext>
+bool FSMDefinition<TEvent, TContext>::process(StateId& current, Context& context, const TEvent& event) const {
+    const auto& state = states_[current];
+
+    if constexpr (is_byte_event_v<TEvent>) {
+        if (state.byte_table) {
+            const auto byte = static_cast<unsigned char>(event);
+            std::uint16_t first = (*state.byte_table)[byte];
+            if (first == NO_TRANSITION) {
+                return false;
+            }
+            // The first admitting transition usually decides; later ones only matter
+            // when its opaque predicates reject the byte
+            for (std::uint32_t t = state.transitions.begin + first; t != state.transitions.end; ++t) {
+                if (predicatesPass(t, context, event)) {
+                    takeTransition(current, t, context, event);
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    if (state.dispatch) {
+        const auto& dispatch = *state.dispatch;
+        IndexRange range = dispatch.lookup(key_extractor_(event));
+        for (std::uint32_t i = range.begin; i != range.end; ++i) {
+            const std::uint32_t t = dispatch.candidates[i];
+            if (predicatesPass(t, context, event)) {
+                takeTransition(current, t, context, event);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    for (std::uint32_t t = state.transitions.begin; t != state.transitions.end; ++t) {
+        if (predicatesPass(t, context, event)) {
+            takeTransition(current, t, context, event);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template<typename TEvent, typename TContext>
+void FSMDefinition<TEvent, TContext>::changeState(StateId& current, StateId target, const TEvent& event) const {
+    static_assert(std::is_void_v<TContext>, "This definition's actions need a context");
+    NoContext none;
+    changeState(current, target, none, event);
+}
+
+template<typename TEvent, typename TContext>
+void FSMDefinition<TEvent, TContext>::changeState(StateId& current, StateId target, Context& context,
+                                                  const TEvent& event) const {
+    if (current != INVALID_STATE_ID && current != target) {
+        runActions(state_info_[current].on_exit_actions, context, event);
+    }
+
+    current = target;
+    runActions(state_info_[target].on_enter_actions, context, event);
+}
+
+template<typename TEvent, typename TContext>
+std::size_t FSMDefinition<TEvent, TContext>::processBytes(StateId& current, std::string_view input) const {
+    static_assert(std::is_void_v<TContext>, "This definition's guards and actions need a context");
+    NoContext none;
+    return processBytes(current, none, input);
+}
+
+template<typename TEvent, typename TContext>
+std::size_t FSMDefinition<TEvent, TContext>::processBytes(StateId& current, Context& context, std::string_view input) const {
+    static_assert(is_byte_event_v<TEvent>, "processBytes() requires a byte event type (char, signed char or unsigned char)");
+
+    const char* p = input.data();
+    const char* const end = p + input.size();
+
+    while (p != end) {
+        const auto& state = states_[current];
+
+        if (state.byte_run) {
+            const char* stop = state.byte_run->exit_scanner.find(p, end);
+            if (stop != p) {
+                const IndexRange span_range = span_action_ranges_[state.byte_run->transition];
+                std::string_view run(p, static_cast<std::size_t>(stop - p));
+                for (std::uint32_t i = span_range.begin; i != span_range.end; ++i) {
+                    call(span_actions_[i], context, run);
+                }
+                p = stop;
+                if (p == end) {
+                    break;
+                }
+            }
+        }
+
+        if (!process(current, context, static_cast<TEvent>(*p))) {
+            break;
+        }
+        ++p;
+    }
+
+    return static_cast<std::size_t>(p - input.data());
+}
+
+template<typename TEvent, typename TContext>
+void FSMDefinition<TEvent, TContext>::takeTransition(StateId& current, std::uint32_t transition, Context& context,
+                                                     const TEvent& event) const {
+    runTransitionActions(transition, context, event);
+
+    const StateId target = targets_[transition];
+    if (target != current) {
+        runActions(state_info_[current].on_exit_actions, context, event);
+        current = target;
+        runActions(state_info_[current].on_enter_actions, context, event);
+    }
+}
+
+template<typename TEvent, typename TContext>
+template<typename T, typename Source>
+typename FSMDefinition<TEvent, TContext>::IndexRange
+FSMDefinition<TEvent, TContext>::appendRange(std::vector<T>& dest, const Source& source) {
+    IndexRange range;
+    range.begin = static_cast<std::uint32_t>(dest.size());
+    dest.insert(dest.end(), source.begin(), source.end());
+    range.end = static_cast<std::uint32_t>(dest.size());
+    return range;
+}
+
+template<typename TEvent, typename TContext>
+std::unique_ptr<typename FSMDefinition<TEvent, TContext>::KeyDispatch>
+FSMDefinition<TEvent, TContext>::buildKeyDispatch(const std::pmr::vector<Transition<TEvent, std::string_view, TContext>>& transitions, std::uint32_t first) {
+    std::vector<EventKey> keys;
+    for (const auto& transition : transitions) {
+        if (transition.hasKey()) {
+            keys.push_back(transition.getKey());
+        }
+    }
+    if (keys.empty()) {
+        return nullptr;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    auto dispatch = std::make_unique<KeyDispatch>();
+
+    // Appends the candidates for one slot: matching keyed plus all unkeyed transitions
+    auto append_slot = [&](const EventKey* key) {
+        IndexRange range;
+        range.begin = static_cast<std::uint32_t>(dispatch->candidates.size());
+        for (std::uint32_t i = 0; i < transitions.size(); ++i) {
+            if (!transitions[i].hasKey() || (key && transitions[i].getKey() == *key)) {
+                dispatch->candidates.push_back(first + i);
+            }
+        }
+        range.end = static_cast<std::uint32_t>(dispatch->candidates.size());
+        dispatch->slots.push_back(range);
+    };
+
+    for (const auto& key : keys) {
+        append_slot(&key);
+    }
+    append_slot(nullptr); // Fallback for keys without keyed transitions
+
+    // Dense array when the key range is compact, hash table otherwise
+    const EventKey span = keys.back() - keys.front();
+    if (span < std::max<EventKey>(16, 4 * keys.size())) {
+        dispatch->min_key = keys.front();
+        dispatch->dense_slots.assign(static_cast<std::size_t>(span) + 1, KeyDispatch::NO_SLOT);
+        for (std::uint32_t slot = 0; slot < keys.size(); ++slot) {
+            dispatch->dense_slots[static_cast<std::size_t>(keys[slot] - dispatch->min_key)] = slot;
+        }
+    } else {
+        dispatch->sparse_slots.reserve(keys.size());
+        for (std::uint32_t slot = 0; slot < keys.size(); ++slot) {
+            dispatch->sparse_slots.emplace(keys[slot], slot);
+        }
+    }
+
+    return dispatch;
+}
+
+template<typename TEvent, typename TContext>
+std::unique_ptr<typename FSMDefinition<TEvent, TContext>::ByteTable>
+FSMDefinition<TEvent, TContext>::buildByteTable(IndexRange transitions) const {
+    const std::uint32_t count = transitions.end - transitions.begin;
+    if (count >= NO_TRANSITION) {
+        return nullptr; // Offsets would not fit; fall back to scanning
+    }
+
+    auto table = std::make_unique<ByteTable>();
+    table->fill(NO_TRANSITION);
+    for (unsigned byte = 0; byte < 256; ++byte) {
+        for (std::uint16_t i = 0; i < count; ++i) {
+            if (char_classes_[transitions.begin + i].contains(static_cast<unsigned char>(byte))) {
+                (*table)[byte] = i;
+                break;
+            }
+        }
+    }
+    return table;
+}
+
+template<typename TEvent, typename TContext>
+std::unique_ptr<typename FSMDefinition<TEvent, TContext>::ByteRun>
+FSMDefinition<TEvent, TContext>::buildByteRun(StateId state, IndexRange transitions, const ByteTable& table) const {
+    for (std::uint32_t t = transitions.begin; t != transitions.end; ++t) {
+        const IndexRange guards = guard_ranges_[t];
+        const IndexRange actions = action_ranges_[t];
+        if (targets_[t] != state || guards.begin != guards.end || actions.begin != actions.end) {
+            continue;
+        }
+
+        // Bytes the table routes elsewhere (or nowhere) end the run
+        const auto offset = static_cast<std::uint16_t>(t - transitions.begin);
+        CharClass exits;
+        for (unsigned byte = 0; byte < 256; ++byte) {
+            if (table[byte] != offset) {
+                exits.add(static_cast<unsigned char>(byte));
+            }
+        }
+        if (exits.count() == 256) {
+            continue; // Shadowed by earlier transitions
+        }
+
+        auto run = std::make_unique<ByteRun>();
+        run->transition = t;
+        run->exit_scanner = ByteScanner(exits);
+        return run;
+    }
+    return nullptr;
+}
+
+template<typename TEvent, typename TContext>
+typename FSMDefinition<TEvent, TContext>::IndexRange
+FSMDefinition<TEvent, TContext>::KeyDispatch::lookup(EventKey key) const {
+    std::uint32_t slot = NO_SLOT;
+    if (!dense_slots.empty()) {
+        EventKey offset = key - min_key; // Wraps for keys below min_key
+        if (offset < dense_slots.size()) {
+            slot = dense_slots[static_cast<std::size_t>(offset)];
+        }
+    } else {
+        auto it = sparse_slots.find(key);
+        if (it != sparse_slots.end()) {
+            slot = it->second;
+        }
+    }
+    return slots[slot == NO_SLOT ? slots.size() - 1 : slot];
+}
+
+template<typename TEvent, typename TContext>
+bool FSMDefinition<TEvent, TContext>::predicatesPass(std::uint32_t transition, Context& context, const TEvent& event) const {
+    if constexpr (is_byte_event_v<TEvent>) {
+        if (!char_classes_[transition].contains(static_cast<unsigned char>(event))) {
+            return false;
+        }
+    }
+    const IndexRange guards = guard_ranges_[transition];
+    for (std::uint32_t i = guards.begin; i != guards.end; ++i) {
+        if (!call(guards_[i], context, event)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename TEvent, typename TContext>
+void FSMDefinition<TEvent, TContext>::runActions(IndexRange actions, Context& context, const TEvent& event) const {
+    for (std::uint32_t i = actions.begin; i != actions.end; ++i) {
+        call(actions_[i], context, event);
+    }
+}
+
+template<typename TEvent, typename TContext>
+void FSMDefinition<TEvent, TContext>::runTransitionActions(std::uint32_t transition, Context& context,
+                                                           const TEvent& event) const {
+    runActions(action_ranges_[transition], context, event);
+
+    if constexpr (is_byte_event_v<TEvent>) {
+        const IndexRange span_range = span_action_ranges_[transition];
+        const char byte = static_cast<char>(event);
+        for (std::uint32_t i = span_range.begin; i != span_range.end; ++i) {
+            call(span_actions_[i], context, std::string_view(&byte, 1));
+        }
+    }
+}
+
+template<typename TEvent, typename TContext>
+template<typename F, typename Arg>
+decltype(auto) FSMDefinition<TEvent, TContext>::call(const F& function, [[maybe_unused]] Context& context,
+                                                     const Arg& arg) {
+    if constexpr (std::is_void_v<TContext>) {
+        return function(arg);
+    } else {
+        return function(context, arg);
+    }
+}
+
+} // namespace fsmgine
@@ -0,0 +1,265 @@
+/// @file FSMInstance.hpp
+/// @brief Lightweight runtime cursor over a shared FSMDefinition
+/// @ingroup core
+
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <variant> // For std::monostate
+#include "FSMgine/FSMDefinition.hpp"
+
+namespace fsmgine {
+
+/// @brief A running machine: a shared FSMDefinition plus the current StateId
+/// @tparam TEvent The event type used for transitions (defaults to std::monostate for event-less FSMs)
+/// @tparam TContext The context guards and actions receive, or void (see FSM)
+/// @ingroup core
+///
+/// @details An FSMInstance holds only a reference to its definition and the id of its
+/// current state, so one definition can back any number of live sessions. Copying an
+/// instance is cheap and yields an independent cursor over the same definition.
+///
+/// @par Context Mode
+/// An instance of a context-mode definition is constructed with a reference to its
+/// context and passes it to every guard and action. The context must outlive the
+/// instance; copies of the instance share it.
+///
+/// @par Thread Safety
+/// An FSMInstance is not internally synchronized in either library variant. Drive each
+/// instance from one thread at a time; the shared definition itself is read-only.
+///
+/// @par Example
+/// @code{.cpp}
+/// FSM<Event> fsm;
+/// fsm.get_builder().from("Idle").predicate(is_start).to("Working");
+///
+/// auto definition = fsm.compileDefinition();  // Build once
+/// FSMInstance<Event> session_a(definition);  // One per connection
+/// FSMInstance<Event> session_b(definition);
+/// session_a.setInitialState("Idle");
+/// session_a.process(Event{"start"});
+///
+/// // Context mode: one definition, per-session state in the context
+/// FSM<char, std::string_view, Lexer> blueprint;
+/// blueprint.get_builder().from("START").predicate(memberFn<&Lexer::isDigit>).to("NUMBER");
+/// auto lexer_definition = blueprint.compileDefinition();
+/// Lexer lexer;
+/// FSMInstance<char, Lexer> scanner(lexer_definition, lexer);
+/// @endcode
+template<typename TEvent = std::monostate, typename TContext>
+class FSMInstance {
+public:
+    /// @brief Type alias for the definition this instance runs
+    using Definition = FSMDefinition<TEvent, TContext>;
+
+    /// @brief The context type; NoContext when guards and actions take none
+    using Context = typename Definition::Context;
+
+    /// @brief Constructs an uninitialized instance of the given definition
+    /// @param definition The shared definition to run
+    /// @throws std::invalid_argument if definition is null
+    /// @note Only available without a context
+    explicit FSMInstance(std::shared_ptr<const Definition> definition);
+
+    /// @brief Constructs an uninitialized instance bound to a context
+    /// @param definition The shared definition to run
+    /// @param context The context passed to guards and actions; must outlive the instance
+    /// @throws std::invalid_argument if definition is null
+    FSMInstance(std::shared_ptr<const Definition> definition, Context& context);
+
+    /// @brief Gets the definition this instance runs
+    /// @return The shared definition
+    const std::shared_ptr<const Definition>& getDefinition() const { return definition_; }
+
+    /// @brief Sets the initial state of the instance
+    /// @param state The name of the initial state
+    /// @throws FSMInvalidStateError if the state doesn't exist
+    /// @note This also executes any on-enter actions for the initial state
+    void setInitialState(std::string_view state);
+
+    /// @brief Changes the current state of the instance
+    /// @param state The name of the state to switch to
+    /// @throws FSMInvalidStateError if the state doesn't exist
+    /// @note This executes on-exit actions for the current state and on-enter actions for the new state
+    void setCurrentState(std::string_view state);
+
+    /// @brief Gets the name of the current state
+    /// @return The current state name
+    /// @throws FSMNotInitializedError if no initial state has been set
+    std::string_view getCurrentState() const;
+
+    /// @brief Gets the id of the current state
+    /// @return The current StateId, or INVALID_STATE_ID if no state has been set
+    StateId getCurrentStateId() const { return current_state_; }
+
+    /// @brief Looks up the id of a state by name
+    /// @param state The state name
+    /// @return The StateId, or INVALID_STATE_ID if the state doesn't exist
+    StateId findState(std::string_view state) const { return definition_->findState(state); }
+
+    /// @brief Gets the name of a state by id
+    /// @param id A StateId obtained from this instance's definition
+    /// @return The state name
+    /// @throws FSMStateNotFoundError if the id is out of range
+    std::string_view getStateName(StateId id) const { return definition_->getStateName(id); }
+
+    /// @brief Gets the number of states in the definition
+    /// @return The state count; valid ids are [0, getStateCount())
+    std::size_t getStateCount() const { return definition_->getStateCount(); }
+
+    /// @brief Processes an event and potentially transitions to a new state
+    /// @param event The event to process
+    /// @return true if a transition occurred, false otherwise
+    /// @throws FSMNotInitializedError if no initial state has been set
+    bool process(const TEvent& event);
+
+    /// @brief Processes a sequence of events in order
+    /// @tparam InputIt Input iterator whose value type converts to TEvent
+    /// @param first Iterator to the first event
+    /// @param last Iterator past the last event
+    /// @return The number of transitions taken and the index of the first unmatched event
+    /// @throws FSMNotInitializedError if no initial state has been set
+    /// @note Events that match no transition are skipped; processing continues with the next one
+    template<typename InputIt>
+    BatchResult processBatch(InputIt first, InputIt last);
+
+    /// @brief Processes a transition for event-less instances
+    /// @return true if a transition occurred, false otherwise
+    /// @note This method is only available for FSMInstance<> or FSMInstance<std::monostate>
+    bool process() {
+        static_assert(std::is_same_v<TEvent, std::monostate>, "process() can only be used with event-less FSMs (FSMInstance<> or FSMInstance<std::monostate>).");
+        return process(std::monostate{});
+    }
+
+    /// @brief Processes a buffer of bytes in one call
+    /// @param input The bytes to process, in order
+    /// @return The number of bytes consumed; processing stops before the first byte
+    ///         for which no transition exists
+    /// @throws FSMNotInitializedError if no initial state has been set
+    /// @note Only available for byte events (char, signed char, unsigned char)
+    /// @note Self-loop runs are skipped with a vectorized scan; see FSMDefinition
+    std::size_t processBytes(std::string_view input);
+
+    /// @brief Processes a chunk of a byte stream, resuming where the previous chunk ended
+    /// @param chunk The bytes to process; may be any fragment of a longer stream
+    /// @return How many bytes were consumed and whether a byte was rejected
+    /// @throws FSMNotInitializedError if no initial state has been set
+    /// @note Only available for byte events (char, signed char, unsigned char)
+    /// @note A run split across chunks is reported to span actions once per chunk
+    FeedResult feed(std::string_view chunk);
+
+private:
+    // The bound context; a shared placeholder without a context
+    Context& context() const;
+
+    std::shared_ptr<const Definition> definition_;
+    StateId current_state_ = INVALID_STATE_ID;
+    Context* context_ = nullptr;
+};
+
+/// @brief A self-contained compiled machine, as returned by FSM::compile()
+/// @ingroup core
+/// @details Equivalent to an FSMInstance owning the only reference to its definition.
+template<typename TEvent = std::monostate>
+using CompiledFSM = FSMInstance<TEvent>;
+
+// --- Implementation ---
+
+template<typename TEvent, typename TContext>
+FSMInstance<TEvent, TContext>::FSMInstance(std::shared_ptr<const Definition> definition)
+    : definition_(std::move(definition)) {
+    static_assert(std::is_void_v<TContext>, "This definition's instances must be bound to a context");
+    if (!definition_) {
+        throw std::invalid_argument("FSMInstance requires a definition");
+    }
+}
+
+template<typename TEvent, typename TContext>
+FSMInstance<TEvent, TContext>::FSMInstance(std::shared_ptr<const Definition> definition, Context& context)
+    : definition_(std::move(definition)), context_(&context) {
+    if (!definition_) {
+        throw std::invalid_argument("FSMInstance requires a definition");
+    }
+}
+
+template<typename TEvent, typename TContext>
+typename FSMInstance<TEvent, TContext>::Context& FSMInstance<TEvent, TContext>::context() const {
+    if constexpr (std::is_void_v<TContext>) {
+        static NoContext none;
+        return none;
+    } else {
+        return *context_;
+    }
+}
+
+template<typename TEvent, typename TContext>
+void FSMInstance<TEvent, TContext>::setInitialState(std::string_view state) {
+    StateId id = definition_->requireState(state, "Cannot set initial state to undefined state: ");
+
+    static const TEvent dummy_event{};
+    current_state_ = INVALID_STATE_ID;
+    definition_->changeState(current_state_, id, context(), dummy_event);
+}
+
+template<typename TEvent, typename TContext>
+void FSMInstance<TEvent, TContext>::setCurrentState(std::string_view state) {
+    StateId id = definition_->requireState(state, "Cannot set current state to undefined state: ");
+
+    static const TEvent dummy_event{};
+    definition_->changeState(current_state_, id, context(), dummy_event);
+}
+
+template<typename TEvent, typename TContext>
+std::string_view FSMInstance<TEvent, TContext>::getCurrentState() const {
+    if (current_state_ == INVALID_STATE_ID) {
+        throw FSMNotInitializedError();
+    }
+    return definition_->getStateName(current_state_);
+}
+
+template<typename TEvent, typename TContext>
+bool FSMInstance<TEvent, TContext>::process(const TEvent& event) {
+    if (current_state_ == INVALID_STATE_ID) {
+        throw FSMNotInitializedError();
+    }
+    return definition_->process(current_state_, context(), event);
+}
+
+template<typename TEvent, typename TContext>
+template<typename InputIt>
+BatchResult FSMInstance<TEvent, TContext>::processBatch(InputIt first, InputIt last) {
+    if (current_state_ == INVALID_STATE_ID) {
+        throw FSMNotInitializedError();
+    }
+    const Definition& definition = *definition_;
+    Context& bound = context();
+    BatchResult result;
+    for (std::size_t index = 0; first != last; ++first, ++index) {
+        if (definition.process(current_state_, bound, *first)) {
+            ++result.transitions;
+        } else if (result.first_unmatched == BatchResult::npos) {
+            result.first_unmatched = index;
+        }
+    }
+    return result;
+}
+
+template<typename TEvent, typename TContext>
+std::size_t FSMInstance<TEvent, TContext>::processBytes(std::string_view input) {
+    if (current_state_ == INVALID_STATE_ID) {
+        throw FSMNotInitializedError();
+    }
+    return definition_->processBytes(current_state_, context(), input);
+}
+
+template<typename TEvent, typename TContext>
+FeedResult FSMInstance<TEvent, TContext>::feed(std::string_view chunk) {
+    FeedResult result;
+    result.consumed = processBytes(chunk);
+    result.rejected = result.consumed < chunk.size();
+    return result;
+}
+
+} // namespace fsmgine
@@ -0,0 +1,497 @@
+/// @file FSMRuntime.hpp
+/// @brief Worker pool that drives many FSMInstance objects as actors
+/// @ingroup core
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "FSMgine/EventQueue.hpp"
+#include "FSMgine/FSMInstance.hpp"
+
+namespace fsmgine {
+
+/// @brief Load counters of one FSMRuntime worker
+/// @ingroup core
+struct WorkerStats {
+    /// @brief Instances waiting in the worker's run queue
+    std::size_t queue_depth = 0;
+
+    /// @brief Events the worker has processed
+    std::uint64_t events_processed = 0;
+
+    /// @brief Instances the worker took from other workers' run queues
+    std::uint64_t steals = 0;
+
+    /// @brief Instances that faulted on the worker (see FSMRuntime::getFault())
+    std::uint64_t faults = 0;
+};
+
+/// @brief Runs many FSMInstance objects on a fixed pool of worker threads
+/// @tparam TEvent The event type of the instances
+/// @tparam TContext The context type of the instances (see FSM)
+/// @ingroup core
+///
+/// @details Each spawned instance becomes an actor with its own mailbox, a bounded
+/// EventQueue that post() appends to from any thread. An instance with mail is
+/// scheduled onto one worker's run queue, and the scheduled flag keeps it there until
+/// that worker has run it, so an instance runs on at most one worker at a time and
+/// needs no locking of its own. A worker processes up to `batch_size` events of an
+/// instance per turn, then moves on; an instance with mail left goes to the back of
+/// the queue.
+///
+/// Run queues are per worker. Instances posted to from a worker thread are scheduled on
+/// that worker, others round-robin. A worker whose queue is empty steals from the back
+/// of another worker's queue before going to sleep.
+///
+/// An exception thrown while an instance processes an event faults that instance only:
+/// the exception is recorded for getFault(), the rest of its mailbox is discarded and
+/// post() to it fails from then on. Other instances keep running. A faulted instance
+/// stays allocated until it is despawned.
+///
+/// @par Thread Safety
+/// spawn(), post(), despawn(), getFault() and getWorkerStats() may be called from any
+/// thread, including from actions running on the workers.
+///
+/// @par Example
+/// @code{.cpp}
+/// auto definition = session_fsm.compileDefinition();
+/// FSMRuntime<Message> runtime(4);
+///
+/// FSMInstance<Message> session(definition);
+/// session.setInitialState("CONNECTED");
+/// auto handle = runtime.spawn(std::move(session));
+///
+/// runtime.post(handle, Message{"hello"});
+/// runtime.waitIdle();
+/// @endcode
+template<typename TEvent, typename TContext = void>
+class FSMRuntime {
+public:
+    /// @brief Type alias for the instances the runtime drives
+    using Instance = FSMInstance<TEvent, TContext>;
+
+    /// @brief Default number of mailbox slots per instance
+    static constexpr std::size_t DEFAULT_MAILBOX_CAPACITY = 64;
+
+    /// @brief Default number of events an instance processes per turn
+    static constexpr std::size_t DEFAULT_BATCH_SIZE = 32;
+
+private:
+    static constexpr unsigned SCHEDULED = 1;
+    static constexpr unsigned RETIRED = 2;
+
+    struct Actor {
+        Actor(Instance&& spawned, std::size_t mailbox_capacity)
+            : instance(std::move(spawned)), mailbox(mailbox_capacity) {}
+
+        Instance instance;
+        EventQueue<TEvent> mailbox;
+        // SCHEDULED is held by whoever may run or free the actor; despawn() sets RETIRED
+        // in the same operation, so seeing RETIRED means despawn() is done with the actor
+        std::atomic<unsigned> flags{0};
+        std::atomic<bool> faulted{false};
+        std::exception_ptr fault; // Written once, before faulted is set
+        std::size_t slot = 0;               // Index in actors_, under actors_mutex_
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Actor*> run_queue;
+        std::atomic<std::size_t> queue_depth{0};
+        std::atomic<std::uint64_t> events_processed{0};
+        std::atomic<std::uint64_t> steals{0};
+        std::atomic<std::uint64_t> faults{0};
+        std::thread thread;
+    };
+
+public:
+    /// @brief Identifies a spawned instance
+    class Handle {
+    public:
+        /// @brief Constructs a handle that refers to no instance
+        Handle() = default;
+
+        /// @brief Checks whether the handle refers to an instance
+        explicit operator bool() const { return actor_ != nullptr; }
+
+    private:
+        friend class FSMRuntime;
+        explicit Handle(Actor* actor) : actor_(actor) {}
+        Actor* actor_ = nullptr;
+    };
+
+    /// @brief Starts the worker threads
+    /// @param worker_count Number of workers; 0 uses std::thread::hardware_concurrency()
+    /// @param mailbox_capacity Mailbox slots per instance; rounded up to a power of two
+    /// @param batch_size Maximum events an instance processes per turn
+    /// @throws std::invalid_argument if mailbox_capacity or batch_size is zero
+    explicit FSMRuntime(std::size_t worker_count = 0,
+                        std::size_t mailbox_capacity = DEFAULT_MAILBOX_CAPACITY,
+                        std::size_t batch_size = DEFAULT_BATCH_SIZE);
+
+    /// @brief Stops and joins the workers
+    /// @note Events still in mailboxes are discarded; call waitIdle() first to finish them
+    ~FSMRuntime();
+
+    FSMRuntime(const FSMRuntime&) = delete;
+    FSMRuntime& operator=(const FSMRuntime&) = delete;
+
+    /// @brief Hands an instance over to the runtime
+    /// @param instance An instance whose initial state has been set
+    /// @return The handle to post events to
+    /// @throws FSMNotInitializedError if the instance has no current state
+    Handle spawn(Instance instance);
+
+    /// @brief Queues an event for an instance
+    /// @param handle A handle returned by spawn()
+    /// @param event The event to queue
+    /// @return true if the event was queued, false if the instance's mailbox is full or
+    ///         the instance has faulted
+    bool post(Handle handle, TEvent event);
+
+    /// @brief Retires an instance once its queued events have been processed
+    /// @param handle A handle returned by spawn()
+    /// @details Events already in the mailbox are still processed; the instance and its
+    /// mailbox are freed right away if it is idle, otherwise by the worker running it
+    /// once the mailbox is empty. An action may despawn its own instance.
+    /// @warning The handle, and every copy of it, must not be used after this call, and
+    ///          no post() to it may still be running
+    void despawn(Handle handle);
+
+    /// @brief Gets the exception that faulted an instance
+    /// @param handle A handle returned by spawn()
+    /// @return The exception thrown while the instance processed an event, or null if it
+    ///         has not faulted
+    std::exception_ptr getFault(Handle handle) const;
+
+    /// @brief Gets the number of instances spawned and not yet freed
+    std::size_t getInstanceCount() const;
+
+    /// @brief Blocks until every posted event has been processed
+    /// @note Events posted concurrently, including by actions, extend the wait
+    void waitIdle();
+
+    /// @brief Gets an instance, e.g. to read its state
+    /// @param handle A handle returned by spawn()
+    /// @return The instance
+    /// @warning Only safe while no event for the instance is pending, such as after waitIdle()
+    const Instance& getInstance(Handle handle) const { return handle.actor_->instance; }
+
+    /// @brief Gets the number of worker threads
+    std::size_t getWorkerCount() const { return workers_.size(); }
+
+    /// @brief Gets a snapshot of every worker's counters
+    /// @return One entry per worker; the values are read without stopping the workers
+    std::vector<WorkerStats> getWorkerStats() const;
+
+private:
+    void schedule(Actor* actor);
+    void runWorker(std::size_t index);
+    Actor* nextActor(std::size_t index);
+    void runActor(Worker& worker, Actor* actor);
+
+    // Gives up SCHEDULED after a turn, keeping or taking it back if a despawn() or mail
+    // arrived meanwhile
+    void unschedule(Actor* actor);
+
+    // Called with SCHEDULED held: frees a retired idle actor, otherwise queues it
+    void settle(Actor* actor);
+
+    // Frees an actor; the caller holds SCHEDULED and its mailbox is empty
+    void destroy(Actor* actor);
+
+    // Index of the calling thread's worker in this runtime, or workers_.size()
+    std::size_t currentWorker() const;
+
+    const std::size_t mailbox_capacity_;
+    const std::size_t batch_size_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    mutable std::mutex actors_mutex_;
+    std::vector<std::unique_ptr<Actor>> actors_;
+
+    std::atomic<std::size_t> next_worker_{0};  // Round-robin target for outside posts
+    std::atomic<std::size_t> queued_{0};       // Actors in all run queues
+    std::atomic<std::size_t> sleepers_{0};     // Workers waiting on wake_
+    std::atomic<bool> stopping_{false};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+
+    std::atomic<std::size_t> pending_events_{0};
+    std::mutex idle_mutex_;
+    std::condition_variable idle_;
+
+    static thread_local const FSMRuntime* current_runtime_;
+    static thread_local std::size_t current_index_;
+};
+
+// --- Implementation ---
+
+template<typename TEvent, typename TContext>
+thread_local const FSMRuntime<TEvent, TContext>* FSMRuntime<TEvent, TContext>::current_runtime_ = nullptr;
+
+template<typename TEvent, typename TContext>
+thread_local std::size_t FSMRuntime<TEvent, TContext>::current_index_ = 0;
+
+template<typename TEvent, typename TContext>
+FSMRuntime<TEvent, TContext>::FSMRuntime(std::size_t worker_count, std::size_t mailbox_capacity,
+                                         std::size_t batch_size)
+    : mailbox_capacity_(mailbox_capacity), batch_size_(batch_size) {
+    if (mailbox_capacity == 0 || batch_size == 0) {
+        throw std::invalid_argument("FSMRuntime mailbox capacity and batch size must be at least 1");
+    }
+    if (worker_count == 0) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        workers_[i]->thread = std::thread([this, i] { runWorker(i); });
+    }
+}
+
+template<typename TEvent, typename TContext>
+FSMRuntime<TEvent, TContext>::~FSMRuntime() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker->thread.join();
+    }
+}
+
+template<typename TEvent, typename TContext>
+typename FSMRuntime<TEvent, TContext>::Handle FSMRuntime<TEvent, TContext>::spawn(Instance instance) {
+    if (instance.getCurrentStateId() == INVALID_STATE_ID) {
+        throw FSMNotInitializedError();
+    }
+    auto actor = std::make_unique<Actor>(std::move(instance), mailbox_capacity_);
+    Handle handle(actor.get());
+    std::lock_guard<std::mutex> lock(actors_mutex_);
+    actor->slot = actors_.size();
+    actors_.push_back(std::move(actor));
+    return handle;
+}
+
+template<typename TEvent, typename TContext>
+void FSMRuntime<TEvent, TContext>::despawn(Handle handle) {
+    Actor* actor = handle.actor_;
+    // The last access unless the actor is idle: a worker running it may free it as soon
+    // as it sees RETIRED
+    if (!(actor->flags.fetch_or(SCHEDULED | RETIRED) & SCHEDULED)) {
+        settle(actor);
+    }
+}
+
+template<typename TEvent, typename TContext>
+std::exception_ptr FSMRuntime<TEvent, TContext>::getFault(Handle handle) const {
+    Actor* actor = handle.actor_;
+    return actor->faulted.load(std::memory_order_acquire) ? actor->fault : nullptr;
+}
+
+template<typename TEvent, typename TContext>
+std::size_t FSMRuntime<TEvent, TContext>::getInstanceCount() const {
+    std::lock_guard<std::mutex> lock(actors_mutex_);
+    return actors_.size();
+}
+
+template<typename TEvent, typename TContext>
+bool FSMRuntime<TEvent, TContext>::post(Handle handle, TEvent event) {
+    Actor* actor = handle.actor_;
+    if (actor->faulted.load(std::memory_order_relaxed)) {
+        return false; // A racing post() may still get through; the worker discards it
+    }
+    pending_events_.fetch_add(1);
+    if (!actor->mailbox.tryPush(std::move(event))) {
+        pending_events_.fetch_sub(1);
+        return false;
+    }
+    // Pairs with the fence in unschedule(): either the worker sees the event or we see
+    // the actor unscheduled
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!(actor->flags.fetch_or(SCHEDULED) & SCHEDULED)) {
+        schedule(actor);
+    }
+    return true;
+}
+
+template<typename TEvent, typename TContext>
+void FSMRuntime<TEvent, TContext>::waitIdle() {
+    std::unique_lock<std::mutex> lock(idle_mutex_);
+    idle_.wait(lock, [this] { return pending_events_.load() == 0; });
+}
+
+template<typename TEvent, typename TContext>
+std::vector<WorkerStats> FSMRuntime<TEvent, TContext>::getWorkerStats() const {
+    std::vector<WorkerStats> stats(workers_.size());
+    for (std::size_t i = 0; i < workers_.size(); ++i) {
+        stats[i].queue_depth = workers_[i]->queue_depth.load(std::memory_order_relaxed);
+        stats[i].events_processed = workers_[i]->events_processed.load(std::memory_order_relaxed);
+        stats[i].steals = workers_[i]->steals.load(std::memory_order_relaxed);
+        stats[i].faults = workers_[i]->faults.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+template<typename TEvent, typename TContext>
+std::size_t FSMRuntime<TEvent, TContext>::currentWorker() const {
+    return current_runtime_ == this ? current_index_ : workers_.size();
+}
+
+template<typename TEvent, typename TContext>
+void FSMRuntime<TEvent, TContext>::schedule(Actor* actor) {
+    std::size_t index = currentWorker();
+    if (index == workers_.size()) {
+        index = next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    }
+    Worker& worker = *workers_[index];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.run_queue.push_back(actor);
+        worker.queue_depth.store(worker.run_queue.size(), std::memory_order_relaxed);
+    }
+    // Sequentially consistent with the sleeper count in runWorker(), so a worker that is
+    // about to sleep either sees this actor or is woken
+    queued_.fetch_add(1);
+    if (sleepers_.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        wake_.notify_one();
+    }
+}
+
+template<typename TEvent, typename TContext>
+void FSMRuntime<TEvent, TContext>::runWorker(std::size_t index) {
+    current_runtime_ = this;
+    current_index_ = index;
+    Worker& worker = *workers_[index];
+
+    while (!stopping_.load(std::memory_order_relaxed)) {
+        if (Actor* actor = nextActor(index)) {
+            runActor(worker, actor);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleepers_.fetch_add(1);
+        wake_.wait(lock, [this] { return queued_.load() > 0 || stopping_.load(); });
+        sleepers_.fetch_sub(1);
+    }
+}
+
+template<typename TEvent, typename TContext>
+typename FSMRuntime<TEvent, TContext>::Actor* FSMRuntime<TEvent, TContext>::nextActor(std::size_t index) {
+    {
+        Worker& own = *workers_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.run_queue.empty()) {
+            Actor* actor = own.run_queue.front();
+            own.run_queue.pop_front();
+            own.queue_depth.store(own.run_queue.size(), std::memory_order_relaxed);
+            queued_.fetch_sub(1);
+            return actor;
+        }
+    }
+
+    for (std::size_t offset = 1; offset < workers_.size(); ++offset) {
+        Worker& victim = *workers_[(index + offset) % workers_.size()];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (lock.owns_lock() && !victim.run_queue.empty()) {
+            Actor* actor = victim.run_queue.back();
+            victim.run_queue.pop_back();
+            victim.queue_depth.store(victim.run_queue.size(), std::memory_order_relaxed);
+            queued_.fetch_sub(1);
+            workers_[index]->steals.fetch_add(1, std::memory_order_relaxed);
+            return actor;
+        }
+    }
+    return nullptr;
+}
+
+template<typename TEvent, typename TContext>
+void FSMRuntime<TEvent, TContext>::runActor(Worker& worker, Actor* actor) {
+    std::size_t processed = 0;
+    while (processed < batch_size_ && actor->mailbox.tryPop([&worker, actor](TEvent&& event) {
+        if (actor->faulted.load(std::memory_order_relaxed)) {
+            return; // Discarded; still counted so waitIdle() returns
+        }
+        try {
+            actor->instance.process(event);
+        } catch (...) {
+            actor->fault = std::current_exception();
+            actor->faulted.store(true, std::memory_order_release);
+            worker.faults.fetch_add(1, std::memory_order_relaxed);
+        }
+    })) {
+        ++processed;
+    }
+    worker.events_processed.fetch_add(processed, std::memory_order_relaxed);
+
+    if ((actor->flags.load() & RETIRED) && actor->mailbox.empty()) {
+        destroy(actor);
+    } else {
+        unschedule(actor);
+    }
+
+    if (processed != 0 && pending_events_.fetch_sub(processed) == processed) {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        idle_.notify_all();
+    }
+}
+
+template<typename TEvent, typename TContext>
+void FSMRuntime<TEvent, TContext>::unschedule(Actor* actor) {
+    unsigned expected = SCHEDULED;
+    if (!actor->flags.compare_exchange_strong(expected, 0)) {
+        settle(actor); // Retired meanwhile; keep the flag
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // A post() may already have handed the actor to another worker, which can be popping
+    // while this reads; EventQueue::empty() is safe to call off the consumer
+    if (!actor->mailbox.empty() && !(actor->flags.fetch_or(SCHEDULED) & SCHEDULED)) {
+        settle(actor);
+    }
+}
+
+template<typename TEvent, typename TContext>
+void FSMRuntime<TEvent, TContext>::settle(Actor* actor) {
+    if ((actor->flags.load() & RETIRED) && actor->mailbox.empty()) {
+        destroy(actor);
+    } else {
+        schedule(actor);
+    }
+}
+
+template<typename TEvent, typename TContext>
+void FSMRuntime<TEvent, TContext>::destroy(Actor* actor) {
+    std::unique_ptr<Actor> freed;
+    {
+        std::lock_guard<std::mutex> lock(actors_mutex_);
+        const std::size_t slot = actor->slot;
+        freed = std::move(actors_[slot]);
+        if (slot + 1 != actors_.size()) {
+            actors_[slot] = std::move(actors_.back());
+            actors_[slot]->slot = slot;
+        }
+        actors_.pop_back();
+    }
+    // The instance's destructor runs outside the lock
+}
+
+} // namespace fsmgine
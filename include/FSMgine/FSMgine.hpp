@@ -11,11 +11,14 @@
 /// - Compile-time optimizations with string interning
 /// - Two library variants: FSMgine (single-threaded) and FSMgineMT (multi-threaded)
 /// - Fluent builder API for easy FSM construction
+/// - Compilation to an integer-indexed CompiledFSM for hot event loops
+/// - Shared immutable FSMDefinition objects driven by lightweight FSMInstance cursors
+/// - StaticFSM for topologies fixed at compile time
 /// 
 /// @section variants Library Variants
 /// FSMgine provides two library variants:
 /// - **FSMgine**: Single-threaded variant with no synchronization overhead
-/// - **FSMgineMT**: Multi-threaded variant with mutex-based thread safety
+/// - **FSMgineMT**: Multi-threaded variant with reader/writer-lock thread safety
 /// 
 /// Choose the appropriate variant based on your application's threading requirements.
 /// 
@@ -55,9 +58,16 @@
 
 // Main FSMgine header - includes everything you need
 #include "FSMgine/StringInterner.hpp"
+#include "FSMgine/EventQueue.hpp"
+#include "FSMgine/LockPolicy.hpp"
 #include "FSMgine/Transition.hpp"
 #include "FSMgine/FSM.hpp"
 #include "FSMgine/FSMBuilder.hpp"
+#include "FSMgine/FSMDefinition.hpp"
+#include "FSMgine/FSMInstance.hpp"
+#include "FSMgine/CompiledFSM.hpp"
+#include "FSMgine/StaticFSM.hpp"
+#include "FSMgine/FSMRuntime.hpp"
 
 /// @namespace fsm
 /// @brief Convenience namespace alias for fsmgine
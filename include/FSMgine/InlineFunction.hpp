@@ -0,0 +1,206 @@
+/// @file InlineFunction.hpp
+/// @brief Allocation-free type-erased callable for guards and actions
+/// @ingroup utilities
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/// @brief Inline storage, in bytes, of the callables stored by transitions and states
+/// @details Define this before including any FSMgine header (and identically in every
+/// translation unit) to accept larger lambda captures.
+#ifndef FSMGINE_INLINE_FUNCTION_CAPACITY
+#define FSMGINE_INLINE_FUNCTION_CAPACITY 48
+#endif
+
+namespace fsmgine {
+
+template<typename Signature, std::size_t Capacity = FSMGINE_INLINE_FUNCTION_CAPACITY>
+class InlineFunction;
+
+/// @brief A copyable callable wrapper that never allocates
+/// @tparam R The return type
+/// @tparam Args The argument types
+/// @tparam Capacity Bytes of inline storage for the wrapped callable
+/// @ingroup utilities
+///
+/// @details A replacement for `std::function` in FSMgine's Predicate and Action types. The
+/// callable is always stored inside the object; one that does not fit in Capacity bytes is
+/// rejected at compile time instead of being moved to the heap. A call is one indirect
+/// jump through a pointer stored next to the callable, so invoking a guard touches only
+/// the guard object itself.
+///
+/// Empty wrappers (default-constructed, built from `nullptr`, a null function pointer or
+/// an empty `std::function`) test false and throw `std::bad_function_call` when called.
+///
+/// @par Example
+/// @code{.cpp}
+/// InlineFunction<bool(const int&)> is_even = [](const int& x) { return x % 2 == 0; };
+///
+/// std::array<char, 256> big{};
+/// InlineFunction<void()> f = [big] {};  // Does not compile: capture exceeds the capacity
+/// InlineFunction<void()> g = [&big] {}; // Fine: captures a reference
+/// @endcode
+template<typename R, typename... Args, std::size_t Capacity>
+class InlineFunction<R(Args...), Capacity> {
+public:
+    /// @brief Constructs an empty wrapper
+    InlineFunction() noexcept = default;
+
+    /// @brief Constructs an empty wrapper
+    InlineFunction(std::nullptr_t) noexcept {}
+
+    /// @brief Wraps a callable, storing it inline
+    /// @tparam F The callable type; must fit in Capacity bytes and be copy constructible
+    /// @param f The callable to wrap
+    template<typename F,
+             typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineFunction> &&
+                                         std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+    InlineFunction(F&& f) {
+        using Stored = std::decay_t<F>;
+        static_assert(sizeof(Stored) <= Capacity,
+                      "Callable is too large for InlineFunction; capture by reference or pointer, "
+                      "or raise FSMGINE_INLINE_FUNCTION_CAPACITY");
+        static_assert(alignof(Stored) <= alignof(std::max_align_t),
+                      "Callable is over-aligned for InlineFunction");
+        static_assert(std::is_copy_constructible_v<Stored>, "InlineFunction requires a copyable callable");
+        static_assert(std::is_nothrow_move_constructible_v<Stored>,
+                      "InlineFunction requires a callable with a noexcept move constructor");
+
+        if (isNull(f)) {
+            return;
+        }
+        ::new (static_cast<void*>(storage_)) Stored(std::forward<F>(f));
+        invoke_ = &invokeStored<Stored>;
+        manage_ = &manageStored<Stored>;
+    }
+
+    /// @brief Copy constructor; copies the wrapped callable
+    InlineFunction(const InlineFunction& other) {
+        if (other.manage_) {
+            other.manage_(Operation::Copy, storage_, other.storage_);
+            invoke_ = other.invoke_;
+            manage_ = other.manage_;
+        }
+    }
+
+    /// @brief Move constructor; moves the wrapped callable and empties other
+    InlineFunction(InlineFunction&& other) noexcept {
+        if (other.manage_) {
+            other.manage_(Operation::Move, storage_, other.storage_);
+            invoke_ = other.invoke_;
+            manage_ = other.manage_;
+            other.reset();
+        }
+    }
+
+    /// @brief Copy assignment
+    InlineFunction& operator=(const InlineFunction& other) {
+        if (this != &other) {
+            InlineFunction copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    /// @brief Move assignment
+    InlineFunction& operator=(InlineFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.manage_) {
+                other.manage_(Operation::Move, storage_, other.storage_);
+                invoke_ = other.invoke_;
+                manage_ = other.manage_;
+                other.reset();
+            }
+        }
+        return *this;
+    }
+
+    /// @brief Empties the wrapper
+    InlineFunction& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    ~InlineFunction() { reset(); }
+
+    /// @brief Invokes the wrapped callable
+    /// @throws std::bad_function_call if the wrapper is empty
+    R operator()(Args... args) const {
+        return invoke_(storage_, std::forward<Args>(args)...);
+    }
+
+    /// @brief Checks whether a callable is stored
+    explicit operator bool() const noexcept { return manage_ != nullptr; }
+
+private:
+    enum class Operation { Copy, Move, Destroy };
+
+    using Invoker = R (*)(void*, Args&&...);
+    using Manager = void (*)(Operation, void*, void*);
+
+    template<typename Stored>
+    static R invokeStored(void* storage, Args&&... args) {
+        // Like std::function, a void signature discards whatever the callable returns
+        if constexpr (std::is_void_v<R>) {
+            std::invoke(*static_cast<Stored*>(storage), std::forward<Args>(args)...);
+        } else {
+            return std::invoke(*static_cast<Stored*>(storage), std::forward<Args>(args)...);
+        }
+    }
+
+    template<typename Stored>
+    static void manageStored(Operation operation, void* dest, void* source) {
+        switch (operation) {
+        case Operation::Copy:
+            ::new (dest) Stored(*static_cast<const Stored*>(source));
+            break;
+        case Operation::Move:
+            ::new (dest) Stored(std::move(*static_cast<Stored*>(source)));
+            break;
+        case Operation::Destroy:
+            static_cast<Stored*>(dest)->~Stored();
+            break;
+        }
+    }
+
+    static R invokeEmpty(void*, Args&&...) { throw std::bad_function_call(); }
+
+    // Null function pointers and empty std::functions produce an empty wrapper
+    template<typename F>
+    static bool isNull(const F& f) {
+        if constexpr (std::is_pointer_v<F> || std::is_member_pointer_v<F>) {
+            return f == nullptr;
+        } else if constexpr (IsStdFunction<F>::value) {
+            return !f;
+        } else {
+            return false;
+        }
+    }
+
+    template<typename F>
+    struct IsStdFunction : std::false_type {};
+
+    template<typename Sig>
+    struct IsStdFunction<std::function<Sig>> : std::true_type {};
+
+    void reset() noexcept {
+        if (manage_) {
+            manage_(Operation::Destroy, storage_, nullptr);
+            manage_ = nullptr;
+            invoke_ = &invokeEmpty;
+        }
+    }
+
+    // Mutable so that, like std::function, a const wrapper can call a mutable lambda
+    alignas(std::max_align_t) mutable unsigned char storage_[Capacity];
+    Invoker invoke_ = &invokeEmpty;
+    Manager manage_ = nullptr;
+};
+
+} // namespace fsmgine
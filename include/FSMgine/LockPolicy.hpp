@@ -0,0 +1,79 @@
+/// @file LockPolicy.hpp
+/// @brief Selectable processing lock for FSM
+/// @ingroup utilities
+///
+/// @details These choose only the lock that FSM::process() holds. Everything else about
+/// threading is still decided by the library variant: FSMgineMT keeps its atomic current
+/// state, epoch-protected state tables and edit lock under every policy, and
+/// StringInterner is not parameterized. The single-threaded FSMgine variant has none of
+/// that machinery for a lock to complete, so it accepts NoLock only.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace fsmgine {
+
+/// @brief Lock policy for a machine that only one thread processes events on
+/// @ingroup utilities
+///
+/// @details Every operation is a no-op that compiles away. In the FSMgineMT variant the
+/// machine keeps its other thread-safe parts: other threads may still read
+/// getCurrentState(), post() events and make live edits while the owning thread
+/// processes.
+struct NoLock {
+    void lock() noexcept {}
+    bool try_lock() noexcept { return true; }
+    void unlock() noexcept {}
+};
+
+/// @brief Lock policy that blocks in the operating system while the lock is taken
+/// @ingroup utilities
+using Mutex = std::mutex;
+
+/// @brief Lock policy that busy-waits for the lock
+/// @ingroup utilities
+///
+/// @details Suited to machines whose transitions are short and whose threads each run on
+/// their own core: a waiting thread never sleeps, so it takes the lock the moment it is
+/// released. A waiter yields its time slice every few dozen checks, so an oversubscribed
+/// machine degrades rather than stalls.
+class SpinLock {
+public:
+    /// @brief Takes the lock, spinning until it is free
+    void lock() noexcept {
+        while (locked_.exchange(true, std::memory_order_acquire)) {
+            // Wait on plain loads so waiters do not keep stealing the cache line
+            for (int spins = 1; locked_.load(std::memory_order_relaxed); ++spins) {
+                if (spins % 64 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    /// @brief Takes the lock if it is free
+    /// @return true if the lock was taken
+    bool try_lock() noexcept {
+        return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+    }
+
+    /// @brief Releases the lock
+    void unlock() noexcept { locked_.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> locked_{false};
+};
+
+/// @brief Lock policy used when FSM is given none
+/// @ingroup utilities
+/// @details Mutex in the FSMgineMT variant and NoLock in the single-threaded one
+#ifdef FSMGINE_MULTI_THREADED
+using DefaultLockPolicy = Mutex;
+#else
+using DefaultLockPolicy = NoLock;
+#endif
+
+} // namespace fsmgine
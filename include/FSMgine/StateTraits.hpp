@@ -0,0 +1,85 @@
+/// @file StateTraits.hpp
+/// @brief Describes enum types used as the state type of FSM<TEvent, TState>
+/// @ingroup core
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace fsmgine {
+
+/// @brief Size and optional names of an enum used as FSM state type
+/// @tparam TState The state enum
+/// @ingroup core
+///
+/// @details By default the enum must end with a `COUNT` enumerator and its other
+/// enumerators must be the values 0 to COUNT - 1. Specialize the template to describe
+/// an enum without `COUNT`, or to attach a reflection table of names:
+///
+/// @code{.cpp}
+/// enum class Door { CLOSED, OPEN, LOCKED };
+///
+/// template<>
+/// struct fsmgine::StateTraits<Door> {
+///     static constexpr std::size_t count = 3;
+///     static constexpr std::string_view names[count] = {"CLOSED", "OPEN", "LOCKED"};
+/// };
+/// @endcode
+template<typename TState>
+struct StateTraits {
+    static_assert(std::is_enum_v<TState>, "FSM state types must be std::string_view or an enum");
+
+    /// @brief Number of states; valid values are 0 to count - 1
+    static constexpr std::size_t count = static_cast<std::size_t>(TState::COUNT);
+};
+
+/// @brief Checks whether FSM<TEvent, TState> names its states with strings
+/// @ingroup core
+template<typename TState>
+inline constexpr bool is_named_state_v = std::is_same_v<TState, std::string_view>;
+
+/// @cond INTERNAL
+template<typename TState, typename = void>
+struct HasStateNames : std::false_type {};
+
+template<typename TState>
+struct HasStateNames<TState, std::void_t<decltype(StateTraits<TState>::names[0])>> : std::true_type {};
+/// @endcond
+
+/// @brief Gets the reflected name of a state
+/// @tparam TState std::string_view or a state enum
+/// @param state The state
+/// @return The name: the state itself for string states, the StateTraits name table
+///         entry for enums that have one, or an empty view
+/// @ingroup core
+template<typename TState>
+std::string_view stateName(TState state) {
+    if constexpr (is_named_state_v<TState>) {
+        return state;
+    } else if constexpr (HasStateNames<TState>::value) {
+        const auto index = static_cast<std::size_t>(state);
+        return index < StateTraits<TState>::count ? std::string_view(StateTraits<TState>::names[index])
+                                                  : std::string_view();
+    } else {
+        return {};
+    }
+}
+
+/// @brief Formats a state for error messages
+/// @return The reflected name, or `#<value>` for enums without one
+/// @ingroup core
+template<typename TState>
+std::string describeState(TState state) {
+    std::string_view name = stateName(state);
+    if constexpr (!is_named_state_v<TState>) {
+        if (name.empty()) {
+            return "#" + std::to_string(static_cast<long long>(state));
+        }
+    }
+    return std::string(name);
+}
+
+} // namespace fsmgine
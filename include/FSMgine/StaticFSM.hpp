@@ -0,0 +1,442 @@
+/// @file StaticFSM.hpp
+/// @brief Finite state machine whose whole topology is fixed at compile time
+/// @ingroup core
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <variant> // For std::monostate
+#include "FSMgine/FSM.hpp"
+
+namespace fsmgine {
+
+/// @brief Type-level vocabulary for declaring a StaticFSM
+/// @ingroup builder
+///
+/// @details Mirrors FSMBuilder: `from<S>` starts a transition, `predicate<G>`,
+/// `on<V>` and `action<A>` refine it, and `to<T>` completes it. `onEnter<S, A>` and
+/// `onExit<S, A>` attach state actions, and `context<C>` gives the machine a context
+/// object. Guards and actions are function object types that are default-constructed at
+/// each call; wrap a free function with `Fn<&function>` and a context member function
+/// with `Member<&C::function>`.
+namespace static_fsm {
+
+/// @brief An ordered list of types
+template<typename... Ts>
+struct TypeList {};
+
+/// @brief Adapts a function (or any constant callable) into a function object type
+/// @tparam F The function to call, e.g. `Fn<&isDigit>`
+template<auto F>
+struct Fn {
+    template<typename... Args>
+    auto operator()(Args&&... args) const -> decltype(F(std::forward<Args>(args)...)) {
+        return F(std::forward<Args>(args)...);
+    }
+};
+
+/// @brief Adapts a member function of the machine's context into a function object type
+/// @tparam M The member function, taking the event, e.g. `Member<&Parser::isDigit>`
+template<auto M>
+struct Member {
+    template<typename TContext, typename TEvent>
+    auto operator()(TContext& context, const TEvent& event) const -> decltype((context.*M)(event)) {
+        return (context.*M)(event);
+    }
+};
+
+/// @brief Guard that accepts events equal to a constant
+/// @tparam Value The event value to match
+template<auto Value>
+struct Equals {
+    template<typename TEvent>
+    bool operator()(const TEvent& event) const {
+        return event == Value;
+    }
+};
+
+/// @brief A completed transition; produced by `from<...>::...::to<...>`
+template<auto From, auto To, typename Guards, typename Actions>
+struct TransitionDef {
+    static constexpr auto source = From;
+    static constexpr auto target = To;
+    using guards = Guards;
+    using actions = Actions;
+};
+
+/// @brief A transition under construction; produced by `from<...>`
+template<auto From, typename Guards, typename Actions>
+struct TransitionSpec;
+
+template<auto From, typename... Guards, typename... Actions>
+struct TransitionSpec<From, TypeList<Guards...>, TypeList<Actions...>> {
+    /// @brief Adds a guard; all guards must return true for the transition to fire
+    template<typename Guard>
+    using predicate = TransitionSpec<From, TypeList<Guards..., Guard>, TypeList<Actions...>>;
+
+    /// @brief Adds a guard that matches one event value
+    template<auto Value>
+    using on = predicate<Equals<Value>>;
+
+    /// @brief Adds an action, run in declaration order when the transition fires
+    template<typename Action>
+    using action = TransitionSpec<From, TypeList<Guards...>, TypeList<Actions..., Action>>;
+
+    /// @brief Completes the transition with its target state
+    template<auto To>
+    using to = TransitionDef<From, To, TypeList<Guards...>, TypeList<Actions...>>;
+};
+
+/// @brief Starts a transition from a state
+template<auto From>
+using from = TransitionSpec<From, TypeList<>, TypeList<>>;
+
+/// @brief An action run when a state is entered
+template<auto State, typename Action>
+struct onEnter {
+    static constexpr auto state = State;
+    using action = Action;
+};
+
+/// @brief An action run when a state is exited
+template<auto State, typename Action>
+struct onExit {
+    static constexpr auto state = State;
+    using action = Action;
+};
+
+/// @brief Binds each machine to an object of type TContext
+/// @details A StaticFSM declared with this entry is constructed from a `TContext&`.
+/// Guards and actions that accept `(TContext&, const TEvent&)` are called with it, the
+/// same signature as FSM's context mode; the others are called with the event alone.
+template<typename TContext>
+struct context {
+    using type = TContext;
+};
+
+template<typename Entry>
+struct IsTransition : std::false_type {};
+
+template<auto From, auto To, typename Guards, typename Actions>
+struct IsTransition<TransitionDef<From, To, Guards, Actions>> : std::true_type {};
+
+template<typename Entry>
+struct IsOnEnter : std::false_type {};
+
+template<auto State, typename Action>
+struct IsOnEnter<onEnter<State, Action>> : std::true_type {};
+
+template<typename Entry>
+struct IsOnExit : std::false_type {};
+
+template<auto State, typename Action>
+struct IsOnExit<onExit<State, Action>> : std::true_type {};
+
+template<typename Entry>
+struct IsContext : std::false_type {};
+
+template<typename TContext>
+struct IsContext<context<TContext>> : std::true_type {};
+
+/// @brief The context type declared among Entries, or void
+template<typename... Entries>
+struct ContextOf {
+    using type = void;
+};
+
+template<typename TContext, typename... Rest>
+struct ContextOf<context<TContext>, Rest...> {
+    using type = TContext;
+};
+
+template<typename First, typename... Rest>
+struct ContextOf<First, Rest...> : ContextOf<Rest...> {};
+
+/// @brief Calls a guard or action with the context when it accepts one
+template<typename F, typename TContext, typename TEvent>
+decltype(auto) call([[maybe_unused]] TContext* context, const TEvent& event) {
+    if constexpr (!std::is_void_v<TContext>) {
+        if constexpr (std::is_invocable_v<const F&, TContext&, const TEvent&>) {
+            return F{}(*context, event);
+        } else {
+            return F{}(event);
+        }
+    } else {
+        return F{}(event);
+    }
+}
+
+/// @brief A set of distinct states, in order of insertion
+template<typename TState, std::size_t Capacity>
+struct StateList {
+    std::array<TState, Capacity> states{};
+    std::size_t count = 0;
+
+    constexpr void add(TState state) {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (states[i] == state) {
+                return;
+            }
+        }
+        states[count++] = state;
+    }
+};
+
+/// @brief Collects the distinct source states of the transitions among Entries
+template<typename TState, typename... Entries>
+constexpr StateList<TState, sizeof...(Entries) + 1> sourceStates() {
+    StateList<TState, sizeof...(Entries) + 1> list;
+    (
+        [&list] {
+            if constexpr (IsTransition<Entries>::value) {
+                static_assert(std::is_same_v<std::decay_t<decltype(Entries::source)>, TState> &&
+                                  std::is_same_v<std::decay_t<decltype(Entries::target)>, TState>,
+                              "StaticFSM transition states must have the machine's state type");
+                list.add(Entries::source);
+            }
+        }(),
+        ...);
+    return list;
+}
+
+} // namespace static_fsm
+
+/// @brief A finite state machine whose states, guards and actions are template parameters
+/// @tparam TState Enum (or integral) type naming the states
+/// @tparam TEvent The event type (std::monostate for event-less machines)
+/// @tparam Entries Transitions, on-enter and on-exit actions declared with the
+///         static_fsm vocabulary, in priority order
+/// @ingroup core
+///
+/// @details For machines whose topology never changes at runtime. There is no state
+/// table, no string interning and no type-erased callable: process() compares the
+/// current state against each source state in turn and, for the matching one, tests its
+/// transitions in declaration order with every guard and action inlined. The comparison
+/// chain is plain inline code; whether it becomes a jump table is left to the compiler.
+///
+/// Guard and action types are default-constructed at every call and hold no data.
+/// Per-machine data lives in a context: declare `static_fsm::context<C>` among the
+/// entries and construct the machine from a `C&`. Guards and actions taking
+/// `(C&, const TEvent&)`, such as `Member<&C::function>` or `Fn<&function>` of a
+/// function with that signature, then receive it.
+///
+/// @par Thread Safety
+/// Not internally synchronized in either library variant; drive each machine from one
+/// thread at a time.
+///
+/// @par Example
+/// @code{.cpp}
+/// enum class Light { RED, GREEN, YELLOW };
+/// struct IsTick { bool operator()(const int& e) const { return e == 1; } };
+///
+/// using namespace fsmgine::static_fsm;
+/// using TrafficLight = StaticFSM<Light, int,
+///     from<Light::RED>::predicate<IsTick>::to<Light::GREEN>,
+///     from<Light::GREEN>::predicate<IsTick>::to<Light::YELLOW>,
+///     from<Light::YELLOW>::predicate<IsTick>::action<Fn<&logStop>>::to<Light::RED>,
+///     onEnter<Light::RED, Fn<&logRed>>>;
+///
+/// TrafficLight light;
+/// light.setInitialState(Light::RED);
+/// light.process(1); // GREEN
+///
+/// struct Counter { int ticks = 0; void tick(const int&) { ++ticks; } };
+/// using CountingLight = StaticFSM<Light, int, context<Counter>,
+///     from<Light::RED>::predicate<IsTick>::action<Member<&Counter::tick>>::to<Light::GREEN>>;
+///
+/// Counter counter;
+/// CountingLight counting(counter);
+/// @endcode
+template<typename TState, typename TEvent, typename... Entries>
+class StaticFSM {
+    static_assert(std::is_enum_v<TState> || std::is_integral_v<TState>,
+                  "StaticFSM states must be an enum or integral type");
+
+    static_assert((0 + ... + static_cast<int>(static_fsm::IsContext<Entries>::value)) <= 1,
+                  "StaticFSM takes at most one context entry");
+
+public:
+    /// @brief The type declared with static_fsm::context, or void
+    using Context = typename static_fsm::ContextOf<Entries...>::type;
+
+    /// @brief Default constructor; the machine has no state until setInitialState()
+    /// @note Only available for machines without a context
+    StaticFSM() {
+        static_assert(std::is_void_v<Context>, "A StaticFSM with a context must be constructed from it");
+    }
+
+    /// @brief Constructs a machine bound to a context
+    /// @param context Passed to guards and actions; must outlive the machine
+    template<typename C = Context, typename = std::enable_if_t<!std::is_void_v<C>>>
+    explicit StaticFSM(C& context) : context_(&context) {}
+
+    /// @brief Sets the initial state of the FSM
+    /// @param state The initial state
+    /// @note This also executes any on-enter actions for the initial state
+    void setInitialState(TState state);
+
+    /// @brief Changes the current state of the FSM
+    /// @param state The state to transition to
+    /// @note This executes on-exit actions for the current state and on-enter actions for the new state.
+    ///       As with FSM::setCurrentState(), on-exit actions are skipped when the state does not change
+    void setCurrentState(TState state);
+
+    /// @brief Gets the current state
+    /// @return The current state
+    /// @throws FSMNotInitializedError if no initial state has been set
+    TState getCurrentState() const;
+
+    /// @brief Processes an event and potentially transitions to a new state
+    /// @param event The event to process
+    /// @return true if a transition occurred, false otherwise
+    /// @throws FSMNotInitializedError if no initial state has been set
+    bool process(const TEvent& event);
+
+    /// @brief Processes a transition for event-less FSMs
+    /// @return true if a transition occurred, false otherwise
+    /// @note This method is only available for event type std::monostate
+    bool process() {
+        static_assert(std::is_same_v<TEvent, std::monostate>, "process() can only be used with event-less FSMs (TEvent = std::monostate).");
+        return process(std::monostate{});
+    }
+
+private:
+    // Distinct source states, in order of first appearance
+    static constexpr auto SOURCES = static_fsm::sourceStates<TState, Entries...>();
+
+    template<std::size_t... I>
+    bool dispatch(const TEvent& event, std::index_sequence<I...>);
+
+    template<TState State>
+    bool processFrom(const TEvent& event);
+
+    template<TState State, typename Entry>
+    bool tryTransition(const TEvent& event);
+
+    template<typename... Guards>
+    bool guardsPass(const TEvent& event, static_fsm::TypeList<Guards...>);
+
+    template<typename... Actions>
+    void runActions(const TEvent& event, static_fsm::TypeList<Actions...>);
+
+    void executeOnEnterActions(TState state, const TEvent& event);
+    void executeOnExitActions(TState state, const TEvent& event);
+
+    Context* context_ = nullptr;
+    TState current_{};
+    bool has_initial_state_ = false;
+};
+
+// --- Implementation ---
+
+template<typename TState, typename TEvent, typename... Entries>
+void StaticFSM<TState, TEvent, Entries...>::setInitialState(TState state) {
+    current_ = state;
+    has_initial_state_ = true;
+    executeOnEnterActions(state, TEvent{});
+}
+
+template<typename TState, typename TEvent, typename... Entries>
+void StaticFSM<TState, TEvent, Entries...>::setCurrentState(TState state) {
+    if (has_initial_state_ && current_ != state) {
+        executeOnExitActions(current_, TEvent{});
+    }
+    current_ = state;
+    has_initial_state_ = true;
+    executeOnEnterActions(state, TEvent{});
+}
+
+template<typename TState, typename TEvent, typename... Entries>
+TState StaticFSM<TState, TEvent, Entries...>::getCurrentState() const {
+    if (!has_initial_state_) {
+        throw FSMNotInitializedError();
+    }
+    return current_;
+}
+
+template<typename TState, typename TEvent, typename... Entries>
+bool StaticFSM<TState, TEvent, Entries...>::process(const TEvent& event) {
+    if (!has_initial_state_) {
+        throw FSMNotInitializedError();
+    }
+    return dispatch(event, std::make_index_sequence<SOURCES.count>{});
+}
+
+template<typename TState, typename TEvent, typename... Entries>
+template<std::size_t... I>
+bool StaticFSM<TState, TEvent, Entries...>::dispatch(const TEvent& event, std::index_sequence<I...>) {
+    bool taken = false;
+    (void)((current_ == SOURCES.states[I] && (taken = processFrom<SOURCES.states[I]>(event), true)) || ...);
+    return taken;
+}
+
+template<typename TState, typename TEvent, typename... Entries>
+template<TState State>
+bool StaticFSM<TState, TEvent, Entries...>::processFrom(const TEvent& event) {
+    return (tryTransition<State, Entries>(event) || ...);
+}
+
+template<typename TState, typename TEvent, typename... Entries>
+template<TState State, typename Entry>
+bool StaticFSM<TState, TEvent, Entries...>::tryTransition(const TEvent& event) {
+    if constexpr (static_fsm::IsTransition<Entry>::value) {
+        if constexpr (Entry::source == State) {
+            if (!guardsPass(event, typename Entry::guards{})) {
+                return false;
+            }
+            runActions(event, typename Entry::actions{});
+            if constexpr (Entry::target != State) {
+                executeOnExitActions(State, event);
+                current_ = Entry::target;
+                executeOnEnterActions(Entry::target, event);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename TState, typename TEvent, typename... Entries>
+template<typename... Guards>
+bool StaticFSM<TState, TEvent, Entries...>::guardsPass(const TEvent& event, static_fsm::TypeList<Guards...>) {
+    return (static_cast<bool>(static_fsm::call<Guards>(context_, event)) && ...);
+}
+
+template<typename TState, typename TEvent, typename... Entries>
+template<typename... Actions>
+void StaticFSM<TState, TEvent, Entries...>::runActions(const TEvent& event, static_fsm::TypeList<Actions...>) {
+    (static_fsm::call<Actions>(context_, event), ...);
+}
+
+template<typename TState, typename TEvent, typename... Entries>
+void StaticFSM<TState, TEvent, Entries...>::executeOnEnterActions([[maybe_unused]] TState state,
+                                                                 [[maybe_unused]] const TEvent& event) {
+    (
+        [&] {
+            if constexpr (static_fsm::IsOnEnter<Entries>::value) {
+                if (Entries::state == state) {
+                    static_fsm::call<typename Entries::action>(context_, event);
+                }
+            }
+        }(),
+        ...);
+}
+
+template<typename TState, typename TEvent, typename... Entries>
+void StaticFSM<TState, TEvent, Entries...>::executeOnExitActions([[maybe_unused]] TState state,
+                                                                [[maybe_unused]] const TEvent& event) {
+    (
+        [&] {
+            if constexpr (static_fsm::IsOnExit<Entries>::value) {
+                if (Entries::state == state) {
+                    static_fsm::call<typename Entries::action>(context_, event);
+                }
+            }
+        }(),
+        ...);
+}
+
+} // namespace fsmgine
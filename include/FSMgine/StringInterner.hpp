@@ -4,9 +4,12 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <string_view>
-#include <unordered_set>
+#include <vector>
 
 #ifdef FSMGINE_MULTI_THREADED
 #include <mutex>
@@ -17,6 +20,22 @@
 
 namespace fsmgine {
 
+/// @brief Memory held by the StringInterner
+/// @ingroup utilities
+struct InternerMemoryUsage {
+    /// @brief Distinct strings interned
+    std::size_t strings = 0;
+
+    /// @brief Bytes of string data, counting one terminating null per string
+    std::size_t string_bytes = 0;
+
+    /// @brief Bytes allocated for string chunks, including unused tails
+    std::size_t arena_bytes = 0;
+
+    /// @brief Bytes allocated for the hash tables that index the strings
+    std::size_t table_bytes = 0;
+};
+
 /// @brief Provides memory-efficient string storage through string interning
 /// @ingroup utilities
 /// 
@@ -27,12 +46,21 @@ namespace fsmgine {
 /// - Guaranteed string_view safety throughout the FSM lifetime
 /// - Thread-safe operations when using the FSMgineMT library variant
 /// 
+/// String bytes are copied into large append-only chunks that are never moved or freed
+/// before clear(), which is what keeps every returned view valid. Each chunk holds many
+/// names back to back, so a machine's names usually share a few cache lines, and
+/// interning costs an allocation only when a chunk fills. The strings are indexed by
+/// open-addressed tables of (hash, pointer, length) entries; a lookup compares the stored
+/// hash and length before it touches the string bytes.
+///
 /// @note This is a singleton class - use StringInterner::instance() to access
 /// 
 /// @par Thread Safety
 /// Thread-safety depends on which library variant you're using:
 /// - **FSMgine**: No thread synchronization, must be used from a single thread
-/// - **FSMgineMT**: All operations are protected by mutexes for thread-safe access
+/// - **FSMgineMT**: All operations are protected by mutexes for thread-safe access.
+///   Strings are spread over SHARD_COUNT shards by hash, each with its own mutex, so
+///   threads interning different names rarely wait for each other
 /// 
 /// @warning The clear() method is NOT thread-safe in either variant and should 
 /// only be used in single-threaded test scenarios.
@@ -61,17 +89,50 @@ public:
     /// @note This method exists solely to reset state between tests
     void clear();
 
+    /// @brief Reports how much memory the interned strings and their index take
+    /// @return Totals over every shard
+    InternerMemoryUsage getMemoryUsage() const;
+
 private:
     StringInterner() = default;
     ~StringInterner() = default;
     StringInterner(const StringInterner&) = delete;
     StringInterner& operator=(const StringInterner&) = delete;
 
-    std::unordered_set<std::string> interned_strings_;
-    
 #ifdef FSMGINE_MULTI_THREADED
-    mutable std::mutex mutex_;
+    static constexpr std::size_t SHARD_COUNT = 32;
+#else
+    static constexpr std::size_t SHARD_COUNT = 1;
 #endif
+
+    // Size of a string chunk; longer strings get a chunk of their own
+    static constexpr std::size_t CHUNK_SIZE = 4096;
+
+    struct Entry {
+        std::size_t hash = 0;
+        const char* data = nullptr; // nullptr marks an empty slot
+        std::size_t length = 0;
+    };
+
+    // One slice of the interned set. Shards sit on separate cache lines so their locks
+    // do not contend.
+    struct alignas(64) Shard {
+        std::vector<Entry> table;                   // Power-of-two sized, linear probing
+        std::size_t count = 0;
+        std::vector<std::unique_ptr<char[]>> chunks;
+        std::size_t chunk_bytes = 0;                // Total size of chunks
+        char* free = nullptr;                       // Unused tail of the newest chunk
+        std::size_t free_size = 0;
+        std::size_t string_bytes = 0;
+#ifdef FSMGINE_MULTI_THREADED
+        mutable std::mutex mutex;
+#endif
+
+        const char* store(std::string_view sv);
+        void grow();
+    };
+
+    std::array<Shard, SHARD_COUNT> shards_;
 };
 
 } // namespace fsmgine
\ No newline at end of file
@@ -4,9 +4,18 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory_resource>
+#include <type_traits>
+#include <optional>
+#include <variant>
 #include <vector>
 #include <string_view>
+#include "FSMgine/CharClass.hpp"
+#include "FSMgine/InlineFunction.hpp"
+#include "FSMgine/LockPolicy.hpp"
 
 /// @defgroup transitions Transition System
 /// @brief Components for managing state transitions
@@ -14,11 +23,183 @@
 namespace fsmgine {
 
 // Forward declaration
-template<typename TEvent>
+template<typename TEvent, typename TState = std::string_view, typename TContext = void,
+         typename TLock = DefaultLockPolicy>
 class TransitionBuilder;
 
+/// @brief Integral key under which a transition is indexed for constant-time dispatch
+/// @ingroup transitions
+/// @details Keys are produced from enum or integral values by toEventKey(), both when a
+/// transition is declared with TransitionBuilder::on() and when an event is dispatched.
+using EventKey = std::uint64_t;
+
+/// @brief Converts an enum or integral value to an EventKey
+/// @tparam TKey An enum or integral type
+/// @param key The value to convert
+/// @return The key's underlying integral value widened to EventKey
+/// @ingroup transitions
+template<typename TKey>
+constexpr EventKey toEventKey(TKey key) {
+    static_assert(std::is_enum_v<TKey> || std::is_integral_v<TKey>,
+                  "Event keys must be enum or integral values");
+    if constexpr (std::is_enum_v<TKey>) {
+        return static_cast<EventKey>(static_cast<std::underlying_type_t<TKey>>(key));
+    } else {
+        return static_cast<EventKey>(key);
+    }
+}
+
+/// @brief True for std::variant event types
+/// @ingroup transitions
+/// @details The default key extractor of a variant event is its `index()`, so transitions
+/// declared with TransitionBuilder::on<Alternative>() are dispatched by alternative.
+template<typename TEvent>
+inline constexpr bool is_variant_event_v = false;
+
+template<typename... Ts>
+inline constexpr bool is_variant_event_v<std::variant<Ts...>> = true;
+
+/// @cond INTERNAL
+template<typename TAlternative, typename TVariant>
+struct VariantIndex {};
+
+template<typename TAlternative, typename... Ts>
+struct VariantIndex<TAlternative, std::variant<Ts...>> {
+    // Index of the only occurrence of TAlternative, or sizeof...(Ts)
+    static constexpr std::size_t find() {
+        constexpr bool same[] = {std::is_same_v<Ts, TAlternative>...};
+        std::size_t index = sizeof...(Ts);
+        std::size_t matches = 0;
+        for (std::size_t i = 0; i < sizeof...(Ts); ++i) {
+            if (same[i]) {
+                index = i;
+                ++matches;
+            }
+        }
+        return matches == 1 ? index : sizeof...(Ts);
+    }
+
+    static constexpr std::size_t value = find();
+    static_assert(value < sizeof...(Ts), "The alternative must occur exactly once in the variant");
+};
+/// @endcond
+
+/// @brief Index of an alternative within a variant event type
+/// @tparam TAlternative The alternative; must occur exactly once in TVariant
+/// @tparam TVariant A std::variant type
+/// @details Equals the `index()` of events holding TAlternative.
+/// @ingroup transitions
+template<typename TAlternative, typename TVariant>
+inline constexpr std::size_t variant_index_v = VariantIndex<TAlternative, TVariant>::value;
+
+/// @cond INTERNAL
+// First alternative of a variant event that F accepts, or void
+template<typename F, typename... Ts>
+struct FirstAcceptedAlternative {
+    using type = void;
+};
+
+template<typename F, typename T, typename... Ts>
+struct FirstAcceptedAlternative<F, T, Ts...> {
+    using type = std::conditional_t<std::is_invocable_v<F&, const T&>, T,
+                                    typename FirstAcceptedAlternative<F, Ts...>::type>;
+};
+
+// The alternative a guard or action written for one alternative takes; no `type` when
+// F takes the whole event, accepts several alternatives, or TEvent is not a variant
+template<typename F, typename TEvent, typename = void>
+struct AcceptedAlternative {};
+
+template<typename F, typename... Ts>
+struct AcceptedAlternative<F, std::variant<Ts...>,
+                           std::enable_if_t<!std::is_invocable_v<F&, const std::variant<Ts...>&> &&
+                                            (std::is_invocable_v<F&, const Ts&> + ...) == 1>> {
+    using type = typename FirstAcceptedAlternative<F, Ts...>::type;
+};
+/// @endcond
+
+/// @brief Guard and action types of a machine
+/// @tparam TEvent The event type
+/// @tparam TContext The per-instance context type, or void for self-contained callables
+/// @ingroup transitions
+///
+/// @details Without a context, guards and actions are type-erased InlineFunction objects
+/// that carry whatever state they capture. With a context they are plain function
+/// pointers that receive the context as their first argument; the context is bound to
+/// each FSMInstance, so one definition can drive many instances and its callables are
+/// trivially copyable. Captureless lambdas and memberFn<&Context::function> convert to
+/// these pointers.
+template<typename TEvent, typename TContext = void>
+struct Callables {
+    /// @brief Guard predicate
+    using Predicate = bool (*)(TContext&, const TEvent&);
+
+    /// @brief Transition, on-enter or on-exit action
+    using Action = void (*)(TContext&, const TEvent&);
+
+    /// @brief Span action of a byte-event transition
+    using SpanAction = void (*)(TContext&, std::string_view);
+};
+
+/// @brief Guard and action types of a machine without a context
+/// @ingroup transitions
+template<typename TEvent>
+struct Callables<TEvent, void> {
+    /// @brief Guard predicate
+    using Predicate = InlineFunction<bool(const TEvent&)>;
+
+    /// @brief Transition, on-enter or on-exit action
+    using Action = InlineFunction<void(const TEvent&)>;
+
+    /// @brief Span action of a byte-event transition
+    using SpanAction = InlineFunction<void(std::string_view)>;
+};
+
+/// @brief Adapts a context member function into a context-mode guard or action
+/// @tparam Member Pointer to a member function of the context taking one argument
+/// @ingroup transitions
+///
+/// @details Converts to any Callables<TEvent, TContext> pointer whose context is the
+/// member's class and whose argument the member accepts:
+/// @code{.cpp}
+/// builder.from("START").predicate(memberFn<&Tokenizer::isDigit>).to("NUMBER");
+/// @endcode
+template<auto Member>
+struct MemberFunction {
+    /// @brief Guard or action taking the event by reference
+    template<typename R, typename TContext, typename TArg>
+    using Pointer = R (*)(TContext&, const TArg&);
+
+    /// @brief Span action taking the consumed bytes by value
+    template<typename R, typename TContext, typename TArg>
+    using ValuePointer = R (*)(TContext&, TArg);
+
+    template<typename R, typename TContext, typename TArg>
+    constexpr operator Pointer<R, TContext, TArg>() const {
+        return &call<R, TContext, const TArg&>;
+    }
+
+    template<typename R, typename TContext, typename TArg>
+    constexpr operator ValuePointer<R, TContext, TArg>() const {
+        return &call<R, TContext, TArg>;
+    }
+
+private:
+    template<typename R, typename TContext, typename TArg>
+    static R call(TContext& context, TArg arg) {
+        return static_cast<R>((context.*Member)(arg));
+    }
+};
+
+/// @brief A MemberFunction for Member, ready to pass to the builder
+/// @ingroup transitions
+template<auto Member>
+inline constexpr MemberFunction<Member> memberFn{};
+
 /// @brief Represents a transition between states in a finite state machine
 /// @tparam TEvent The event type that triggers transitions
+/// @tparam TState The state type: interned std::string_view names, or an enum (see StateTraits)
+/// @tparam TContext The per-instance context guards and actions receive, or void (see Callables)
 /// @ingroup transitions
 /// 
 /// @details A Transition encapsulates:
@@ -33,24 +214,73 @@ class TransitionBuilder;
 /// - If multiple predicates are added, ALL must return true (AND logic)
 /// - Predicates are evaluated in the order they were added
 /// 
+/// @par Character Classes
+/// - For byte events (see is_byte_event_v) a transition may carry a CharClass guard
+/// - The class is checked before the predicates; an event outside it fails the transition
+/// - Unlike predicates, classes are visible to FSMDefinition, which compiles byte-driven
+///   states into 256-entry dispatch tables
+/// 
+/// @par Event Keys
+/// - A transition may declare an EventKey (see TransitionBuilder::on())
+/// - A keyed transition is only considered when the FSM's key extractor maps the event
+///   to that key; the key is checked by the FSM before any predicate runs
+/// - predicatesPass() does not look at the key
+/// 
 /// @par Action Execution
 /// - Actions are executed in the order they were added
+/// - For byte events, span actions run after the regular actions and receive the
+///   consumed input as a `std::string_view` (one byte when driven by process())
 /// - Actions are only executed if all predicates pass
 /// - Actions are executed before the state change occurs
-template<typename TEvent>
+template<typename TEvent, typename TState = std::string_view, typename TContext = void>
 class Transition {
 public:
     /// @brief Type alias for transition guard predicates
-    using Predicate = std::function<bool(const TEvent&)>;
+    using Predicate = typename Callables<TEvent, TContext>::Predicate;
     
     /// @brief Type alias for transition actions
-    using Action = std::function<void(const TEvent&)>;
+    using Action = typename Callables<TEvent, TContext>::Action;
+    
+    /// @brief Type alias for span actions of byte-event transitions
+    /// @details Receives the consumed bytes; a self-loop run may deliver many bytes at once
+    using SpanAction = typename Callables<TEvent, TContext>::SpanAction;
+    
+    /// @brief Allocator for the guard and action lists
+    /// @details Makes Transition allocator-aware, so a transition stored in an FSM built on
+    /// a std::pmr::memory_resource keeps its lists in that resource.
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
     
     /// @brief Default constructor
     Transition() = default;
     
-    Transition(const Transition&) = delete;
-    Transition& operator=(const Transition&) = delete;
+    /// @brief Constructs an empty transition whose lists allocate from alloc
+    /// @param alloc The allocator to use
+    explicit Transition(const allocator_type& alloc)
+        : predicates_(alloc), actions_(alloc), span_actions_(alloc) {}
+    
+    /// @brief Copy constructor (defaulted); used when a live-edited state is copied on write
+    Transition(const Transition&) = default;
+    
+    /// @brief Allocator-extended copy constructor
+    /// @param other The transition to copy
+    /// @param alloc The allocator for the copy's lists
+    Transition(const Transition& other, const allocator_type& alloc)
+        : predicates_(other.predicates_, alloc), actions_(other.actions_, alloc),
+          span_actions_(other.span_actions_, alloc), target_state_(other.target_state_),
+          has_target_state_(other.has_target_state_), key_(other.key_), has_key_(other.has_key_),
+          char_class_(other.char_class_) {}
+    
+    /// @brief Allocator-extended move constructor
+    /// @param other The transition to move from
+    /// @param alloc The allocator for the new transition's lists
+    Transition(Transition&& other, const allocator_type& alloc)
+        : predicates_(std::move(other.predicates_), alloc), actions_(std::move(other.actions_), alloc),
+          span_actions_(std::move(other.span_actions_), alloc), target_state_(other.target_state_),
+          has_target_state_(other.has_target_state_), key_(other.key_), has_key_(other.has_key_),
+          char_class_(other.char_class_) {}
+    
+    /// @brief Copy assignment operator (defaulted)
+    Transition& operator=(const Transition&) = default;
     
     /// @brief Move constructor (defaulted)
     Transition(Transition&&) = default;
@@ -72,55 +302,116 @@ public:
     /// @note This method is primarily for use by TransitionBuilder
     void addAction(Action action);
     
+    /// @brief Adds a span action to execute when this transition consumes input
+    /// @param action A function receiving the consumed bytes
+    /// @note Only available for byte events (char, signed char, unsigned char)
+    /// @note Null actions are ignored
+    /// @note This method is primarily for use by TransitionBuilder
+    void addSpanAction(SpanAction action);
+    
     /// @brief Sets the target state for this transition
-    /// @param state The name of the state to transition to
-    /// @note The state should be interned using StringInterner for consistency
+    /// @param state The state to transition to
+    /// @note State names should be interned using StringInterner for consistency
+    /// @note This method is primarily for use by TransitionBuilder
+    void setTargetState(TState state);
+    
+    /// @brief Declares the event key this transition is dispatched under
+    /// @param key The key; replaces any key set before
     /// @note This method is primarily for use by TransitionBuilder
-    void setTargetState(std::string_view state);
+    void setKey(EventKey key);
     
-    /// @brief Evaluates all predicates for this transition
+    /// @brief Restricts this transition to events in a character class
+    /// @param char_class The accepted bytes; replaces any class set before
+    /// @note Only available for byte events (char, signed char, unsigned char)
+    /// @note This method is primarily for use by TransitionBuilder
+    void setCharClass(const CharClass& char_class);
+    
+    /// @brief Evaluates the character class and all predicates for this transition
     /// @param event The event to evaluate predicates against
-    /// @return true if all predicates pass (or no predicates exist), false otherwise
+    /// @return true if the event is in the character class (if any) and all predicates
+    ///         pass (or no predicates exist), false otherwise
+    /// @note Only available without a context; FSMDefinition evaluates context-mode guards
     bool predicatesPass(const TEvent& event) const;
     
     /// @brief Executes all actions associated with this transition
     /// @param event The event that triggered the transition
     /// @note Actions are executed in the order they were added
+    /// @note Only available without a context; FSMDefinition runs context-mode actions
     void executeActions(const TEvent& event) const;
     
     /// @brief Gets the target state for this transition
-    /// @return The target state name, or empty string_view if not set
-    std::string_view getTargetState() const;
+    /// @return The target state; an empty name (or value-initialized enum) if not set
+    TState getTargetState() const;
+    
+    /// @brief Gets all predicates associated with this transition
+    /// @return A const reference to the vector of predicates
+    const std::pmr::vector<Predicate>& getPredicates() const;
     
     /// @brief Gets all actions associated with this transition
     /// @return A const reference to the vector of actions
-    const std::vector<Action>& getActions() const;
+    const std::pmr::vector<Action>& getActions() const;
+    
+    /// @brief Gets all span actions associated with this transition
+    /// @return A const reference to the vector of span actions; always empty for non-byte events
+    const std::pmr::vector<SpanAction>& getSpanActions() const;
     
     /// @brief Checks if this transition has any predicates
     /// @return true if at least one predicate exists
     bool hasPredicates() const;
     
     /// @brief Checks if this transition has any actions
-    /// @return true if at least one action exists
+    /// @return true if at least one action or span action exists
     bool hasActions() const;
     
     /// @brief Checks if this transition has a target state
     /// @return true if a target state has been set
     bool hasTargetState() const;
+    
+    /// @brief Checks if this transition is dispatched under an event key
+    /// @return true if setKey() has been called
+    bool hasKey() const;
+    
+    /// @brief Gets the event key of this transition
+    /// @return The key, or 0 if hasKey() is false
+    EventKey getKey() const;
+    
+    /// @brief Checks if this transition is guarded by a character class
+    /// @return true if setCharClass() has been called; always false for non-byte events
+    bool hasCharClass() const;
+    
+    /// @brief Gets the character class guarding this transition
+    /// @return The class, or CharClass::any() if hasCharClass() is false
+    CharClass getCharClass() const;
 
 private:
     // Friend declaration for builder access
-    friend class TransitionBuilder<TEvent>;
+    template<typename, typename, typename, typename>
+    friend class TransitionBuilder;
     
-    std::vector<Predicate> predicates_;
-    std::vector<Action> actions_;
-    std::string_view target_state_;
+    std::pmr::vector<Predicate> predicates_;
+    std::pmr::vector<Action> actions_;
+    std::pmr::vector<SpanAction> span_actions_;
+    TState target_state_{};
+    bool has_target_state_ = false;
+    EventKey key_ = 0;
+    bool has_key_ = false;
+    
+    // Character classes only exist for byte events
+    struct NoCharClass {};
+    std::conditional_t<is_byte_event_v<TEvent>, std::optional<CharClass>, NoCharClass> char_class_;
 };
 
 // --- Implementation ---
 
-template<typename TEvent>
-bool Transition<TEvent>::predicatesPass(const TEvent& event) const {
+template<typename TEvent, typename TState, typename TContext>
+bool Transition<TEvent, TState, TContext>::predicatesPass(const TEvent& event) const {
+    static_assert(std::is_void_v<TContext>, "Context-mode guards are evaluated by FSMDefinition");
+    if constexpr (is_byte_event_v<TEvent>) {
+        if (char_class_ && !char_class_->contains(static_cast<unsigned char>(event))) {
+            return false;
+        }
+    }
+    
     if (predicates_.empty()) {
         return true;
     }
@@ -133,55 +424,127 @@ bool Transition<TEvent>::predicatesPass(const TEvent& event) const {
     return true;
 }
 
-template<typename TEvent>
-void Transition<TEvent>::executeActions(const TEvent& event) const {
+template<typename TEvent, typename TState, typename TContext>
+void Transition<TEvent, TState, TContext>::executeActions(const TEvent& event) const {
+    static_assert(std::is_void_v<TContext>, "Context-mode actions are run by FSMDefinition");
     for (const auto& action : actions_) {
         action(event);
     }
+    
+    if constexpr (is_byte_event_v<TEvent>) {
+        const char byte = static_cast<char>(event);
+        for (const auto& action : span_actions_) {
+            action(std::string_view(&byte, 1));
+        }
+    }
 }
 
-template<typename TEvent>
-std::string_view Transition<TEvent>::getTargetState() const {
+template<typename TEvent, typename TState, typename TContext>
+TState Transition<TEvent, TState, TContext>::getTargetState() const {
     return target_state_;
 }
 
-template<typename TEvent>
-const std::vector<typename Transition<TEvent>::Action>& Transition<TEvent>::getActions() const {
+template<typename TEvent, typename TState, typename TContext>
+const std::pmr::vector<typename Transition<TEvent, TState, TContext>::Predicate>& Transition<TEvent, TState, TContext>::getPredicates() const {
+    return predicates_;
+}
+
+template<typename TEvent, typename TState, typename TContext>
+const std::pmr::vector<typename Transition<TEvent, TState, TContext>::Action>& Transition<TEvent, TState, TContext>::getActions() const {
     return actions_;
 }
 
-template<typename TEvent>
-bool Transition<TEvent>::hasPredicates() const {
+template<typename TEvent, typename TState, typename TContext>
+const std::pmr::vector<typename Transition<TEvent, TState, TContext>::SpanAction>& Transition<TEvent, TState, TContext>::getSpanActions() const {
+    return span_actions_;
+}
+
+template<typename TEvent, typename TState, typename TContext>
+bool Transition<TEvent, TState, TContext>::hasPredicates() const {
     return !predicates_.empty();
 }
 
-template<typename TEvent>
-bool Transition<TEvent>::hasActions() const {
-    return !actions_.empty();
+template<typename TEvent, typename TState, typename TContext>
+bool Transition<TEvent, TState, TContext>::hasActions() const {
+    return !actions_.empty() || !span_actions_.empty();
 }
 
-template<typename TEvent>
-bool Transition<TEvent>::hasTargetState() const {
-    return !target_state_.empty();
+template<typename TEvent, typename TState, typename TContext>
+bool Transition<TEvent, TState, TContext>::hasTargetState() const {
+    if constexpr (std::is_same_v<TState, std::string_view>) {
+        return !target_state_.empty();
+    } else {
+        return has_target_state_;
+    }
 }
 
-template<typename TEvent>
-void Transition<TEvent>::addPredicate(Predicate pred) {
+template<typename TEvent, typename TState, typename TContext>
+void Transition<TEvent, TState, TContext>::addPredicate(Predicate pred) {
     if (pred) {
         predicates_.push_back(std::move(pred));
     }
 }
 
-template<typename TEvent>
-void Transition<TEvent>::addAction(Action action) {
+template<typename TEvent, typename TState, typename TContext>
+void Transition<TEvent, TState, TContext>::addAction(Action action) {
     if (action) {
         actions_.push_back(std::move(action));
     }
 }
 
-template<typename TEvent>
-void Transition<TEvent>::setTargetState(std::string_view state) {
+template<typename TEvent, typename TState, typename TContext>
+void Transition<TEvent, TState, TContext>::addSpanAction(SpanAction action) {
+    static_assert(is_byte_event_v<TEvent>, "Span actions require a byte event type (char, signed char or unsigned char)");
+    if (action) {
+        span_actions_.push_back(std::move(action));
+    }
+}
+
+template<typename TEvent, typename TState, typename TContext>
+void Transition<TEvent, TState, TContext>::setTargetState(TState state) {
     target_state_ = state;
+    has_target_state_ = true;
+}
+
+template<typename TEvent, typename TState, typename TContext>
+void Transition<TEvent, TState, TContext>::setKey(EventKey key) {
+    key_ = key;
+    has_key_ = true;
+}
+
+template<typename TEvent, typename TState, typename TContext>
+bool Transition<TEvent, TState, TContext>::hasKey() const {
+    return has_key_;
+}
+
+template<typename TEvent, typename TState, typename TContext>
+EventKey Transition<TEvent, TState, TContext>::getKey() const {
+    return key_;
+}
+
+template<typename TEvent, typename TState, typename TContext>
+void Transition<TEvent, TState, TContext>::setCharClass(const CharClass& char_class) {
+    static_assert(is_byte_event_v<TEvent>, "Character classes require a byte event type (char, signed char or unsigned char)");
+    char_class_ = char_class;
+}
+
+template<typename TEvent, typename TState, typename TContext>
+bool Transition<TEvent, TState, TContext>::hasCharClass() const {
+    if constexpr (is_byte_event_v<TEvent>) {
+        return char_class_.has_value();
+    } else {
+        return false;
+    }
+}
+
+template<typename TEvent, typename TState, typename TContext>
+CharClass Transition<TEvent, TState, TContext>::getCharClass() const {
+    if constexpr (is_byte_event_v<TEvent>) {
+        if (char_class_) {
+            return *char_class_;
+        }
+    }
+    return CharClass::any();
 }
 
 } // namespace fsmgine
@@ -1,5 +1,8 @@
 #include "FSMgine/StringInterner.hpp"
 
+#include <cstring>
+#include <functional>
+
 namespace fsmgine {
 
 StringInterner& StringInterner::instance() {
@@ -8,26 +11,106 @@ StringInterner& StringInterner::instance() {
 }
 
 std::string_view StringInterner::intern(const std::string& str) {
-#ifdef FSMGINE_MULTI_THREADED
-    std::lock_guard<std::mutex> lock(mutex_);
-#endif
-    
-    auto [it, inserted] = interned_strings_.insert(str);
-    return std::string_view(*it);
+    return intern(std::string_view(str));
 }
 
 std::string_view StringInterner::intern(std::string_view sv) {
+    // Slots are picked with the low bits of the hash, so pick the shard with the high ones
+    const std::size_t hash = std::hash<std::string_view>{}(sv);
+    Shard& shard = shards_[(hash >> (sizeof(std::size_t) * 8 - 8)) % SHARD_COUNT];
+
 #ifdef FSMGINE_MULTI_THREADED
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(shard.mutex);
 #endif
-    
-    auto [it, inserted] = interned_strings_.emplace(sv);
-    return std::string_view(*it);
+
+    // Keep the table at most three quarters full so probes stay short
+    if ((shard.count + 1) * 4 > shard.table.size() * 3) {
+        shard.grow();
+    }
+
+    const std::size_t mask = shard.table.size() - 1;
+    for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        Entry& entry = shard.table[slot];
+        if (entry.data == nullptr) {
+            entry = Entry{hash, shard.store(sv), sv.size()};
+            ++shard.count;
+            return std::string_view(entry.data, entry.length);
+        }
+        if (entry.hash == hash && entry.length == sv.size() &&
+            std::memcmp(entry.data, sv.data(), sv.size()) == 0) {
+            return std::string_view(entry.data, entry.length);
+        }
+    }
 }
 
 void StringInterner::clear() {
     // Note: This is not thread-safe and is intended for testing only
-    interned_strings_.clear();
+    for (auto& shard : shards_) {
+        shard.table.clear();
+        shard.count = 0;
+        shard.chunks.clear();
+        shard.chunk_bytes = 0;
+        shard.free = nullptr;
+        shard.free_size = 0;
+        shard.string_bytes = 0;
+    }
+}
+
+InternerMemoryUsage StringInterner::getMemoryUsage() const {
+    InternerMemoryUsage usage;
+    for (const auto& shard : shards_) {
+#ifdef FSMGINE_MULTI_THREADED
+        std::lock_guard<std::mutex> lock(shard.mutex);
+#endif
+        usage.strings += shard.count;
+        usage.string_bytes += shard.string_bytes;
+        usage.arena_bytes += shard.chunk_bytes;
+        usage.table_bytes += shard.table.capacity() * sizeof(Entry);
+    }
+    return usage;
+}
+
+const char* StringInterner::Shard::store(std::string_view sv) {
+    // Null-terminated, which also gives empty strings a distinct non-null address
+    const std::size_t size = sv.size() + 1;
+    char* data;
+    if (size > CHUNK_SIZE / 4) {
+        // Long strings get their own chunk so they do not waste the current one's tail
+        chunks.push_back(std::make_unique<char[]>(size));
+        chunk_bytes += size;
+        data = chunks.back().get();
+    } else {
+        if (size > free_size) {
+            chunks.push_back(std::make_unique<char[]>(CHUNK_SIZE));
+            chunk_bytes += CHUNK_SIZE;
+            free = chunks.back().get();
+            free_size = CHUNK_SIZE;
+        }
+        data = free;
+        free += size;
+        free_size -= size;
+    }
+    std::memcpy(data, sv.data(), sv.size());
+    data[sv.size()] = '\0';
+    string_bytes += size;
+    return data;
+}
+
+void StringInterner::Shard::grow() {
+    std::vector<Entry> grown(table.empty() ? 16 : table.size() * 2);
+    const std::size_t mask = grown.size() - 1;
+    for (const Entry& entry : table) {
+        if (entry.data == nullptr) {
+            continue;
+        }
+        // Stored hashes spare rehashing the strings
+        std::size_t slot = entry.hash & mask;
+        while (grown[slot].data != nullptr) {
+            slot = (slot + 1) & mask;
+        }
+        grown[slot] = entry;
+    }
+    table.swap(grown);
 }
 
-} // namespace fsmgine
\ No newline at end of file
+} // namespace fsmgine
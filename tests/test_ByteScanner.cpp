@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "FSMgine/ByteScanner.hpp"
+
+using namespace fsmgine;
+
+namespace {
+
+// Reference implementation: first byte of the buffer in the class
+std::size_t naiveFind(const std::string& buffer, const CharClass& targets) {
+    for (std::size_t i = 0; i < buffer.size(); ++i) {
+        if (targets.contains(static_cast<unsigned char>(buffer[i]))) {
+            return i;
+        }
+    }
+    return buffer.size();
+}
+
+std::size_t scan(const std::string& buffer, const CharClass& targets) {
+    ByteScanner scanner(targets);
+    return static_cast<std::size_t>(scanner.find(buffer.data(), buffer.data() + buffer.size()) - buffer.data());
+}
+
+} // namespace
+
+TEST(ByteScannerTest, DefaultScannerFindsNothing) {
+    std::string buffer = "anything";
+    ByteScanner scanner;
+    EXPECT_EQ(scanner.find(buffer.data(), buffer.data() + buffer.size()), buffer.data() + buffer.size());
+}
+
+TEST(ByteScannerTest, EmptyBuffer) {
+    std::string buffer;
+    EXPECT_EQ(scan(buffer, CharClass::single(';')), 0u);
+}
+
+TEST(ByteScannerTest, MatchesNaiveSearchAtEveryPosition) {
+    // One needle (memchr), several needles (vector compares), and a large class (bitmap)
+    const CharClass classes[] = {
+        CharClass::single(';'),
+        CharClass::parse(";,}\n"),
+        CharClass::parse("0-9"),
+        CharClass::single(0xFF),
+    };
+
+    for (const auto& targets : classes) {
+        for (std::size_t length : {1u, 15u, 16u, 17u, 33u, 100u}) {
+            std::string miss(length, 'x');
+            EXPECT_EQ(scan(miss, targets), length);
+
+            for (std::size_t pos = 0; pos < length; ++pos) {
+                for (unsigned c = 0; c < 256; ++c) {
+                    if (!targets.contains(static_cast<unsigned char>(c))) {
+                        continue;
+                    }
+                    std::string buffer = miss;
+                    buffer[pos] = static_cast<char>(c);
+                    ASSERT_EQ(scan(buffer, targets), naiveFind(buffer, targets)) << "length " << length << " pos " << pos;
+                    break; // One representative target byte per position
+                }
+            }
+        }
+    }
+}
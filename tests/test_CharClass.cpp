@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <cctype>
+#include "FSMgine/CharClass.hpp"
+
+using namespace fsmgine;
+
+TEST(CharClassTest, EmptyAndAny) {
+    CharClass empty;
+    EXPECT_EQ(empty.count(), 0);
+    EXPECT_FALSE(empty.contains('a'));
+
+    CharClass all = CharClass::any();
+    EXPECT_EQ(all.count(), 256);
+    EXPECT_TRUE(all.contains(0));
+    EXPECT_TRUE(all.contains(255));
+}
+
+TEST(CharClassTest, ParseRanges) {
+    auto alnum = CharClass::parse("0-9a-zA-Z");
+    EXPECT_EQ(alnum.count(), 62);
+    for (int c = 0; c < 256; ++c) {
+        EXPECT_EQ(alnum.contains(static_cast<unsigned char>(c)), std::isalnum(c) != 0) << c;
+    }
+}
+
+TEST(CharClassTest, ParseLiteralDashAndEscapes) {
+    auto leading = CharClass::parse("-a");
+    EXPECT_TRUE(leading.contains('-'));
+    EXPECT_TRUE(leading.contains('a'));
+    EXPECT_EQ(leading.count(), 2);
+
+    auto trailing = CharClass::parse("a-");
+    EXPECT_TRUE(trailing.contains('-'));
+    EXPECT_EQ(trailing.count(), 2);
+
+    auto escaped = CharClass::parse("a\\-z");
+    EXPECT_TRUE(escaped.contains('-'));
+    EXPECT_FALSE(escaped.contains('b'));
+    EXPECT_EQ(escaped.count(), 3);
+}
+
+TEST(CharClassTest, ParseErrors) {
+    EXPECT_THROW(CharClass::parse("z-a"), std::invalid_argument);
+    EXPECT_THROW(CharClass::parse("abc\\"), std::invalid_argument);
+}
+
+TEST(CharClassTest, SingleAndComplement) {
+    auto semicolon = CharClass::single(';');
+    auto not_semicolon = semicolon.complement();
+
+    EXPECT_TRUE(semicolon.contains(';'));
+    EXPECT_FALSE(not_semicolon.contains(';'));
+    EXPECT_TRUE(not_semicolon.contains('x'));
+    EXPECT_EQ(not_semicolon.count(), 255);
+    EXPECT_EQ(not_semicolon.complement(), semicolon);
+    EXPECT_NE(not_semicolon, semicolon);
+}
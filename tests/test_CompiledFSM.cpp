@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "FSMgine/FSM.hpp"
+#include "FSMgine/FSMBuilder.hpp"
+#include "FSMgine/CompiledFSM.hpp"
+#include "FSMgine/StringInterner.hpp"
+
+using namespace fsmgine;
+
+class CompiledFSMTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        StringInterner::instance().clear();
+        trace.clear();
+    }
+
+    std::vector<std::string> trace;
+};
+
+TEST_F(CompiledFSMTest, RequiresInitialState) {
+    FSM<> fsm;
+    fsm.get_builder().from("A").to("B");
+
+    auto compiled = fsm.compile();
+    EXPECT_EQ(compiled.getCurrentStateId(), INVALID_STATE_ID);
+    EXPECT_THROW(compiled.getCurrentState(), FSMNotInitializedError);
+    EXPECT_THROW(compiled.process(), FSMNotInitializedError);
+    EXPECT_THROW(compiled.setInitialState("UNDEFINED"), FSMInvalidStateError);
+}
+
+TEST_F(CompiledFSMTest, StateIdsAreDense) {
+    FSM<> fsm;
+    fsm.get_builder().from("A").to("B");
+    fsm.get_builder().from("B").to("C");
+
+    auto compiled = fsm.compile();
+    ASSERT_EQ(compiled.getStateCount(), 3u);
+
+    std::vector<bool> seen(compiled.getStateCount(), false);
+    for (const char* name : {"A", "B", "C"}) {
+        StateId id = compiled.findState(name);
+        ASSERT_LT(id, compiled.getStateCount());
+        EXPECT_EQ(compiled.getStateName(id), name);
+        seen[id] = true;
+    }
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), true), 3);
+    EXPECT_EQ(compiled.findState("D"), INVALID_STATE_ID);
+    EXPECT_THROW(compiled.getStateName(3), FSMStateNotFoundError);
+}
+
+TEST_F(CompiledFSMTest, MatchesSourceFSMBehavior) {
+    enum class Event { COIN, PUSH };
+    FSM<Event> fsm;
+    auto builder = fsm.get_builder();
+
+    builder.onEnter("LOCKED", [this](const Event&) { trace.push_back("enter LOCKED"); })
+           .onExit("LOCKED", [this](const Event&) { trace.push_back("exit LOCKED"); })
+           .onEnter("UNLOCKED", [this](const Event&) { trace.push_back("enter UNLOCKED"); });
+
+    builder.from("LOCKED")
+           .predicate([](const Event& e) { return e == Event::COIN; })
+           .action([this](const Event&) { trace.push_back("coin"); })
+           .to("UNLOCKED");
+
+    builder.from("UNLOCKED")
+           .predicate([](const Event& e) { return e == Event::PUSH; })
+           .to("LOCKED");
+
+    auto compiled = fsm.compile();
+    compiled.setInitialState("LOCKED");
+
+    EXPECT_FALSE(compiled.process(Event::PUSH));
+    EXPECT_EQ(compiled.getCurrentState(), "LOCKED");
+
+    EXPECT_TRUE(compiled.process(Event::COIN));
+    EXPECT_EQ(compiled.getCurrentState(), "UNLOCKED");
+    EXPECT_EQ(compiled.getCurrentStateId(), compiled.findState("UNLOCKED"));
+
+    EXPECT_TRUE(compiled.process(Event::PUSH));
+    EXPECT_EQ(compiled.getCurrentState(), "LOCKED");
+
+    std::vector<std::string> expected = {
+        "enter LOCKED", "coin", "exit LOCKED", "enter UNLOCKED", "enter LOCKED"
+    };
+    EXPECT_EQ(trace, expected);
+}
+
+TEST_F(CompiledFSMTest, FirstValidTransitionWins) {
+    FSM<int> fsm;
+    int chosen = 0;
+
+    fsm.get_builder().from("START")
+        .predicate([](int e) { return e > 10; })
+        .action([&chosen](int) { chosen = 1; })
+        .to("BIG");
+    fsm.get_builder().from("START")
+        .predicate([](int e) { return e > 0; })
+        .action([&chosen](int) { chosen = 2; })
+        .to("POSITIVE");
+
+    auto compiled = fsm.compile();
+    compiled.setInitialState("START");
+    EXPECT_TRUE(compiled.process(5));
+    EXPECT_EQ(chosen, 2);
+    EXPECT_EQ(compiled.getCurrentState(), "POSITIVE");
+}
+
+TEST_F(CompiledFSMTest, SelfTransitionSkipsEnterAndExit) {
+    FSM<> fsm;
+    int actions = 0;
+
+    fsm.get_builder()
+        .onEnter("LOOP", [this](const auto&) { trace.push_back("enter"); })
+        .onExit("LOOP", [this](const auto&) { trace.push_back("exit"); })
+        .from("LOOP")
+        .action([&actions](const auto&) { actions++; })
+        .to("LOOP");
+
+    auto compiled = fsm.compile();
+    compiled.setInitialState("LOOP");
+    EXPECT_TRUE(compiled.process());
+    EXPECT_TRUE(compiled.process());
+    EXPECT_EQ(actions, 2);
+    EXPECT_EQ(trace, std::vector<std::string>{"enter"});
+}
+
+TEST_F(CompiledFSMTest, SetCurrentStateRunsExitAndEnter) {
+    FSM<> fsm;
+    fsm.get_builder()
+        .onExit("A", [this](const auto&) { trace.push_back("exit A"); })
+        .onEnter("B", [this](const auto&) { trace.push_back("enter B"); })
+        .from("A")
+        .to("B");
+
+    auto compiled = fsm.compile();
+    compiled.setCurrentState("A");
+    compiled.setCurrentState("B");
+    EXPECT_EQ(compiled.getCurrentState(), "B");
+    EXPECT_EQ(trace, (std::vector<std::string>{"exit A", "enter B"}));
+    EXPECT_THROW(compiled.setCurrentState("UNDEFINED"), FSMInvalidStateError);
+}
+
+TEST_F(CompiledFSMTest, IndependentOfLaterEdits) {
+    FSM<> fsm;
+    fsm.get_builder().from("A").to("B");
+    auto compiled = fsm.compile();
+
+    fsm.get_builder().from("B").to("C");
+
+    compiled.setInitialState("A");
+    EXPECT_TRUE(compiled.process());
+    EXPECT_FALSE(compiled.process());
+    EXPECT_EQ(compiled.getCurrentState(), "B");
+    EXPECT_EQ(compiled.findState("C"), INVALID_STATE_ID);
+}
+
+TEST_F(CompiledFSMTest, MoveSemantics) {
+    FSM<> fsm;
+    fsm.get_builder().from("A").to("B");
+
+    auto compiled = fsm.compile();
+    compiled.setInitialState("A");
+
+    CompiledFSM<> moved = std::move(compiled);
+    EXPECT_EQ(moved.getCurrentState(), "A");
+    EXPECT_TRUE(moved.process());
+    EXPECT_EQ(moved.getCurrentState(), "B");
+}
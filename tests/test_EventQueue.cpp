@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FSMgine/EventQueue.hpp"
+
+using namespace fsmgine;
+
+TEST(EventQueueTest, RoundsCapacityUpToPowerOfTwo) {
+    EXPECT_EQ(EventQueue<int>(1).capacity(), 1u);
+    EXPECT_EQ(EventQueue<int>(5).capacity(), 8u);
+    EXPECT_EQ(EventQueue<int>(64).capacity(), 64u);
+    EXPECT_THROW(EventQueue<int>(0), std::invalid_argument);
+}
+
+TEST(EventQueueTest, PopsInPushOrderAndRejectsWhenFull) {
+    EventQueue<std::string> queue(4);
+    EXPECT_TRUE(queue.tryPush(std::string("a")));
+    EXPECT_TRUE(queue.tryPush(std::string("b")));
+    EXPECT_TRUE(queue.tryPush(std::string("c")));
+    EXPECT_TRUE(queue.tryPush(std::string("d")));
+    EXPECT_FALSE(queue.tryPush(std::string("e")));
+
+    std::string popped;
+    auto append = [&popped](std::string&& s) { popped += s; };
+    EXPECT_TRUE(queue.tryPop(append));
+    EXPECT_TRUE(queue.tryPush(std::string("e")));  // The freed cell is reused
+    while (queue.tryPop(append)) {
+    }
+    EXPECT_EQ(popped, "abcde");
+}
+
+TEST(EventQueueTest, DestroysQueuedElements) {
+    auto tracker = std::make_shared<int>(0);
+    {
+        EventQueue<std::shared_ptr<int>> queue(8);
+        queue.tryPush(tracker);
+        queue.tryPush(tracker);
+        EXPECT_EQ(tracker.use_count(), 3);
+    }
+    EXPECT_EQ(tracker.use_count(), 1);
+}
+
+TEST(EventQueueTest, ConcurrentProducersKeepTheirOwnOrder) {
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 20000;
+    EventQueue<int> queue(256);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < PER_PRODUCER; ++i) {
+                while (!queue.tryPush(p * PER_PRODUCER + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    int received = 0;
+    bool ordered = true;
+    while (received < PRODUCERS * PER_PRODUCER) {
+        queue.tryPop([&](int&& value) {
+            const int producer = value / PER_PRODUCER;
+            ordered = ordered && value % PER_PRODUCER == next[producer];
+            next[producer]++;
+            received++;
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(next, std::vector<int>(PRODUCERS, PER_PRODUCER));
+}
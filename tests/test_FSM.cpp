@@ -1,11 +1,34 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory_resource>
+#include <string>
 #include <thread>
+#include <type_traits>
+#include <variant>
 #include "FSMgine/FSM.hpp"
 #include "FSMgine/FSMBuilder.hpp"
+#include "FSMgine/CompiledFSM.hpp"
 #include "FSMgine/StringInterner.hpp"
 
 using namespace fsmgine;
 
+namespace {
+
+// Sized by its COUNT enumerator; no names
+enum class Phase { IDLE, RUNNING, DONE, COUNT };
+
+// Sized and named through StateTraits
+enum class Valve { SHUT, OPEN };
+
+} // namespace
+
+template<>
+struct fsmgine::StateTraits<Valve> {
+    static constexpr std::size_t count = 2;
+    static constexpr std::string_view names[count] = {"SHUT", "OPEN"};
+};
+
 // Use an event-less FSM (std::monostate) for these tests to ensure process() works.
 using TestFSM = FSM<>; // Default template argument is std::monostate
 
@@ -214,6 +237,25 @@ TEST_F(FSMTest, SetCurrentStateExecutesActions) {
     EXPECT_EQ(action_call_count, 3); // onExit STATE1 (=2), then onEnter STATE2 (=3)
 }
 
+TEST_F(FSMTest, ActionsMayAddTransitionsToTheirState) {
+    FSM<int> fsm;
+    fsm.get_builder()
+        .from("A")
+        .predicate([](const int& e) { return e == 1; })
+        .action([&fsm](const int&) {
+            // Enough edits to reallocate the state's transition list
+            for (int i = 0; i < 16; ++i) {
+                fsm.get_builder().from("A").predicate([](const int& e) { return e == 2; }).to("A");
+            }
+        })
+        .to("B");
+    fsm.get_builder().from("B").to("B");
+    fsm.setInitialState("A");
+
+    EXPECT_TRUE(fsm.process(1));
+    EXPECT_EQ(fsm.getCurrentState(), "B");
+}
+
 TEST_F(FSMTest, ErrorHandling) {
     TestFSM fsm;
 
@@ -265,6 +307,85 @@ TEST_F(FSMTest, MoveSemantics) {
     // We don't test the moved-from state as it's implementation-defined
 }
 
+namespace {
+
+// Forwards to the new/delete resource and counts live allocations
+class CountingResource : public std::pmr::memory_resource {
+public:
+    int live = 0;
+    int total = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++live;
+        ++total;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        --live;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Makes every allocation from the default resource fail while in scope
+class NoDefaultResource {
+public:
+    NoDefaultResource() : previous_(std::pmr::set_default_resource(std::pmr::null_memory_resource())) {}
+    ~NoDefaultResource() { std::pmr::set_default_resource(previous_); }
+
+private:
+    std::pmr::memory_resource* previous_;
+};
+
+} // namespace
+
+TEST_F(FSMTest, TopologyAllocatesFromMemoryResource) {
+    CountingResource resource;
+    {
+        // Nothing may fall back to the default resource while the machine is built and run
+        NoDefaultResource no_default;
+        {
+            FSM<char> fsm(&resource);
+            fsm.get_builder().onEnter("B", [this](const char&) { action_call_count++; });
+            fsm.get_builder().from("A").predicate([](const char& c) { return c == 'b'; }).to("B");
+            fsm.get_builder().from("B").predicate([](const char& c) { return c == 'a'; }).to("A");
+            fsm.setInitialState("A");
+            fsm.get_builder().from("A").predicate([](const char& c) { return c == 'x'; }).to("A");
+
+            EXPECT_TRUE(fsm.process('b'));
+            EXPECT_TRUE(fsm.process('a'));
+            EXPECT_TRUE(fsm.process('x'));
+            EXPECT_EQ(action_call_count, 1);
+
+            // Moves allocate nothing, so they cannot fail on a bounded resource
+            const int before_move = resource.total;
+            FSM<char> moved(std::move(fsm));
+            FSM<char> assigned(&resource);
+            assigned = std::move(moved);
+            EXPECT_EQ(resource.total, before_move);
+            EXPECT_EQ(assigned.getCurrentState(), "A");
+            EXPECT_TRUE(assigned.process('b'));
+            EXPECT_GT(resource.live, 0);
+
+            // The moved-from machine is empty and uninitialized until rebuilt
+            EXPECT_THROW(fsm.getCurrentState(), FSMNotInitializedError);
+            EXPECT_THROW(fsm.setInitialState("A"), FSMInvalidStateError);
+            fsm.get_builder().from("C").to("C");
+            fsm.setInitialState("C");
+            EXPECT_TRUE(fsm.process('c'));
+        }
+    }
+    EXPECT_GT(resource.total, 0);
+    EXPECT_EQ(resource.live, 0);
+
+    EXPECT_THROW(FSM<char>{nullptr}, std::invalid_argument);
+}
+
 TEST_F(FSMTest, ConcurrentStateAccess) {
     TestFSM fsm;
     std::atomic<int> exceptions_caught{0};
@@ -334,3 +455,589 @@ TEST_F(FSMTest, ConcurrentStateAccess) {
     EXPECT_EQ(invalid_states.load(), 0);
     EXPECT_GT(total_operations.load(), 0);
 }
+
+#ifdef FSMGINE_MULTI_THREADED
+TEST_F(FSMTest, ObserversSeeOnlyCommittedStates) {
+    TestFSM fsm;
+    std::atomic<bool> entering{false};
+    std::atomic<bool> observed{false};
+
+    fsm.get_builder()
+        .onEnter("B", [&](const std::monostate&) {
+            entering = true;
+            // Hold the transition open until the observer has looked
+            while (!observed) {
+                std::this_thread::yield();
+            }
+        })
+        .from("A")
+        .to("B");
+    fsm.setInitialState("A");
+
+    std::thread writer([&fsm]() { fsm.process(); });
+    while (!entering) {
+        std::this_thread::yield();
+    }
+
+    // The writer holds the lock and is inside on-enter; the read must not block
+    EXPECT_EQ(fsm.getCurrentState(), "A");
+    observed = true;
+    writer.join();
+    EXPECT_EQ(fsm.getCurrentState(), "B");
+}
+
+TEST_F(FSMTest, LiveEditsDoNotWaitForProcessing) {
+    TestFSM fsm;
+    std::atomic<bool> entering{false};
+    std::atomic<bool> edited{false};
+
+    fsm.get_builder()
+        .onEnter("B", [&](const std::monostate&) {
+            entering = true;
+            // Hold the processing lock until the edit below has been published
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!edited && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+        })
+        .from("A")
+        .to("B");
+    fsm.setInitialState("A");
+
+    std::thread processor([&fsm]() { fsm.process(); });
+    while (!entering) {
+        std::this_thread::yield();
+    }
+    fsm.get_builder().from("B").to("C");
+    edited = true;
+    processor.join();
+
+    EXPECT_TRUE(fsm.process());
+    EXPECT_EQ(fsm.getCurrentState(), "C");
+}
+
+TEST_F(FSMTest, ConcurrentLiveEditing) {
+    FSM<int> fsm;
+    fsm.get_builder().from("A").predicate([](const int& e) { return e == 0; }).to("B");
+    fsm.get_builder().from("B").predicate([](const int& e) { return e == 0; }).to("A");
+    fsm.setInitialState("A");
+
+    const int EDITS = 200;
+    std::atomic<bool> done{false};
+    std::thread editor([&fsm, &done, EDITS]() {
+        for (int i = 1; i <= EDITS; ++i) {
+            fsm.edit([i](FSMBuilder<int>& builder) {
+                builder.from("A").predicate([i](const int& e) { return e == i; }).to("A");
+                builder.from("B").predicate([i](const int& e) { return e == i; }).to("B");
+            });
+        }
+        done = true;
+    });
+
+    int transitions = 0;
+    for (int e = 0; !done || e < 1000; ++e) {
+        transitions += fsm.process(e % (EDITS + 1)) ? 1 : 0;
+    }
+    editor.join();
+
+    // Every edit is visible once published
+    EXPECT_GT(transitions, 0);
+    for (int i = 1; i <= EDITS; ++i) {
+        EXPECT_TRUE(fsm.process(i));
+    }
+}
+
+TEST_F(FSMTest, FailedEditBatchIsDiscarded) {
+    TestFSM fsm;
+    fsm.get_builder().from("A").to("B");
+    fsm.setInitialState("A");
+
+    EXPECT_THROW(fsm.edit([](FSMBuilder<std::monostate>& builder) {
+        builder.from("A").to("C");
+        throw std::runtime_error("reload failed");
+    }), std::runtime_error);
+
+    EXPECT_TRUE(fsm.process());
+    EXPECT_EQ(fsm.getCurrentState(), "B");
+    EXPECT_FALSE(fsm.process()); // B has no transitions; "A -> C" was not applied
+}
+
+TEST_F(FSMTest, AfterCommitActionsRunOutsideTheLock) {
+    FSM<int> fsm;
+    std::atomic<bool> acting{false};
+    std::atomic<bool> release{false};
+    std::vector<std::string> log;
+
+    fsm.get_builder()
+        .onExit("A", [&log](const int&) { log.push_back("exit A"); })
+        .onEnter("C", [&log](const int&) { log.push_back("enter C"); })
+        .from("A")
+        .predicate([](const int& e) { return e == 1; })
+        .action([&](const int&) {
+            acting = true;
+            // Hold the action open until the second event has been committed
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!release && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            log.push_back("A -> B");
+        })
+        .to("B");
+    fsm.get_builder().from("B").predicate([](const int& e) { return e == 2; }).to("C");
+    fsm.setActionTiming(ActionTiming::AfterCommit);
+    fsm.setInitialState("A");
+
+    std::thread first([&fsm] { fsm.process(1); });
+    while (!acting) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(fsm.getCurrentState(), "B"); // Committed before its action runs
+
+    // The lock is free, so the next event commits while the first action still runs
+    std::thread second([&fsm] { fsm.process(2); });
+    while (fsm.getCurrentState() != "C") {
+        std::this_thread::yield();
+    }
+    release = true;
+    first.join();
+    second.join();
+
+    // The second transition's actions waited for the first's
+    EXPECT_EQ(log, (std::vector<std::string>{"A -> B", "exit A", "enter C"}));
+}
+
+TEST_F(FSMTest, LockPoliciesChoosePerMachine) {
+    static_assert(std::is_same_v<DefaultLockPolicy, Mutex>);
+
+    // Shared machine behind a spin lock
+    FSM<int, std::string_view, void, SpinLock> shared;
+    long long sum = 0;
+    shared.edit([&sum](FSMBuilder<int, std::string_view, void, SpinLock>& builder) {
+        builder.from("COUNTING").action([&sum](const int& e) { sum += e; }).to("COUNTING");
+    });
+    shared.setInitialState("COUNTING");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&shared] {
+            for (int i = 1; i <= 1000; ++i) {
+                shared.process(i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(sum, 4 * 500500LL);
+
+    // Machine driven by one thread; others may still observe it without a lock
+    FSM<int, std::string_view, void, NoLock> owned;
+    owned.get_builder().from("A").predicate([](const int& e) { return e == 1; }).to("B");
+    owned.get_builder().from("B").predicate([](const int& e) { return e == 0; }).to("A");
+    owned.setInitialState("A");
+
+    std::atomic<bool> done{false};
+    std::thread observer([&owned, &done] {
+        while (!done) {
+            auto state = owned.getCurrentState();
+            EXPECT_TRUE(state == "A" || state == "B");
+        }
+    });
+    for (int i = 0; i < 1000; ++i) {
+        owned.process(i % 2 == 0 ? 1 : 0);
+    }
+    done = true;
+    observer.join();
+    EXPECT_EQ(owned.getCurrentState(), "A");
+
+    // Definitions compile from any policy
+    auto definition = owned.compileDefinition();
+    EXPECT_EQ(definition->getStateCount(), 2u);
+}
+
+TEST_F(FSMTest, FlatCombiningServesEveryCaller) {
+    constexpr int THREADS = 8;
+    constexpr int PER_THREAD = 2000;
+    FSM<int> fsm;
+    long long sum = 0; // Actions run under the lock, one at a time
+
+    fsm.get_builder()
+        .from("COUNTING")
+        .predicate([](const int& e) { return e > 0; })
+        .action([&sum](const int& e) { sum += e; })
+        .to("COUNTING");
+    fsm.setFlatCombining(true);
+    EXPECT_TRUE(fsm.isFlatCombining());
+    EXPECT_THROW(fsm.process(1), FSMNotInitializedError); // Delivered through the slot
+    fsm.setInitialState("COUNTING");
+
+    std::atomic<int> transitions{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&fsm, &transitions] {
+            for (int i = 1; i <= PER_THREAD; ++i) {
+                transitions += fsm.process(i) ? 1 : 0;
+                EXPECT_FALSE(fsm.process(0));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(transitions.load(), THREADS * PER_THREAD);
+    EXPECT_EQ(sum, THREADS * (static_cast<long long>(PER_THREAD) * (PER_THREAD + 1) / 2));
+}
+#endif
+
+TEST_F(FSMTest, EditBatch) {
+    TestFSM fsm;
+    fsm.edit([](FSMBuilder<std::monostate>& builder) {
+        builder.from("A").to("B");
+        builder.from("B").to("A");
+    });
+    fsm.setInitialState("A");
+    EXPECT_TRUE(fsm.process());
+    EXPECT_EQ(fsm.getCurrentState(), "B");
+    EXPECT_TRUE(fsm.process());
+    EXPECT_EQ(fsm.getCurrentState(), "A");
+}
+
+TEST_F(FSMTest, KeyedTransitionsWithEnumEvents) {
+    enum class Signal { GO, STOP, PAUSE };
+    FSM<Signal> fsm;
+
+    fsm.get_builder().from("IDLE").on(Signal::GO).to("RUNNING");
+    fsm.get_builder().from("RUNNING").on(Signal::PAUSE).to("PAUSED");
+    fsm.get_builder().from("RUNNING").on(Signal::STOP).to("IDLE");
+
+    fsm.setInitialState("IDLE");
+    EXPECT_FALSE(fsm.process(Signal::STOP));
+    EXPECT_TRUE(fsm.process(Signal::GO));
+    EXPECT_EQ(fsm.getCurrentState(), "RUNNING");
+    EXPECT_TRUE(fsm.process(Signal::STOP));
+    EXPECT_EQ(fsm.getCurrentState(), "IDLE");
+}
+
+TEST_F(FSMTest, VariantEventsDispatchByAlternative) {
+    struct Connect { int id; };
+    struct Data { std::string payload; };
+    struct Close {};
+    using Event = std::variant<Connect, Data, Close>;
+    FSM<Event> fsm;
+    std::string received;
+    int guard_calls = 0;
+
+    fsm.get_builder().from("IDLE").on<Connect>()
+        .predicate([](const Connect& c) { return c.id > 0; })
+        .to("OPEN");
+    fsm.get_builder().from("OPEN").on<Data>()
+        .predicate([&guard_calls](const Data&) { guard_calls++; return true; })
+        .action([&received](const Data& d) { received += d.payload; })
+        .to("OPEN");
+    fsm.get_builder().from("OPEN").on<Close>().to("IDLE");
+
+    fsm.setInitialState("IDLE");
+    EXPECT_FALSE(fsm.process(Data{"x"}));
+    EXPECT_FALSE(fsm.process(Connect{0}));
+    EXPECT_TRUE(fsm.process(Connect{7}));
+    EXPECT_TRUE(fsm.process(Data{"ab"}));
+    EXPECT_FALSE(fsm.process(Connect{1}));
+    EXPECT_TRUE(fsm.process(Data{"c"}));
+    EXPECT_EQ(guard_calls, 2);  // Never evaluated for other alternatives
+    EXPECT_EQ(received, "abc");
+    EXPECT_TRUE(fsm.process(Close{}));
+    EXPECT_EQ(fsm.getCurrentState(), "IDLE");
+
+    auto compiled = fsm.compile();
+    compiled.setInitialState("IDLE");
+    EXPECT_TRUE(compiled.process(Connect{3}));
+    EXPECT_TRUE(compiled.process(Data{"d"}));
+    EXPECT_FALSE(compiled.process(Connect{3}));
+    EXPECT_EQ(guard_calls, 3);
+    EXPECT_EQ(received, "abcd");
+}
+
+TEST_F(FSMTest, EnumStates) {
+    FSM<int, Phase> fsm;
+    int enters = 0;
+
+    fsm.get_builder().onEnter(Phase::RUNNING, [&enters](const int&) { enters++; });
+    fsm.get_builder().from(Phase::IDLE).on(1).to(Phase::RUNNING);
+    fsm.get_builder().from(Phase::RUNNING).predicate([](const int& e) { return e == 2; }).to(Phase::IDLE);
+
+    EXPECT_THROW(fsm.getCurrentState(), FSMNotInitializedError);
+    EXPECT_THROW(fsm.setInitialState(Phase::DONE), FSMInvalidStateError);
+
+    fsm.setInitialState(Phase::IDLE);
+    EXPECT_EQ(fsm.getCurrentState(), Phase::IDLE);
+    EXPECT_FALSE(fsm.process(2));
+    EXPECT_TRUE(fsm.process(1));
+    EXPECT_EQ(fsm.getCurrentState(), Phase::RUNNING);
+    EXPECT_EQ(enters, 1);
+    EXPECT_EQ(fsm.getCurrentStateName(), "");
+
+    std::vector<int> events = {2, 1, 2};
+    EXPECT_EQ(fsm.processBatch(events.begin(), events.end()).transitions, 3u);
+    EXPECT_EQ(fsm.getCurrentState(), Phase::IDLE);
+}
+
+TEST_F(FSMTest, EnumStatesWithNames) {
+    FSM<std::monostate, Valve> fsm;
+    fsm.get_builder().from(Valve::SHUT).to(Valve::OPEN);
+    fsm.get_builder().from(Valve::OPEN).to(Valve::SHUT);
+
+    fsm.setInitialState(Valve::SHUT);
+    EXPECT_EQ(fsm.getCurrentStateName(), "SHUT");
+    EXPECT_TRUE(fsm.process());
+    EXPECT_EQ(fsm.getCurrentState(), Valve::OPEN);
+    EXPECT_EQ(fsm.getCurrentStateName(), "OPEN");
+
+    FSM<std::monostate, Valve> empty;
+    try {
+        empty.setInitialState(Valve::OPEN);
+        FAIL() << "Expected FSMInvalidStateError";
+    } catch (const FSMInvalidStateError& e) {
+        EXPECT_NE(std::string(e.what()).find("OPEN"), std::string::npos);
+    }
+    EXPECT_THROW(fsm.setCurrentState(static_cast<Valve>(7)), FSMInvalidStateError);
+}
+
+TEST_F(FSMTest, KeyedTransitionsRequireExtractorForStructEvents) {
+    struct Message { int type; int payload; };
+    FSM<Message> fsm;
+
+    fsm.get_builder().from("A").on(1).to("B");
+    fsm.setInitialState("A");
+    EXPECT_THROW(fsm.process(Message{1, 0}), FSMInvalidStateError);
+
+    fsm.get_builder()
+        .keyedBy([](const Message& m) { return m.type; })
+        .from("B")
+        .on(2)
+        .predicate([](const Message& m) { return m.payload > 0; })
+        .to("C");
+
+    EXPECT_TRUE(fsm.process(Message{1, 0}));
+    EXPECT_FALSE(fsm.process(Message{2, 0}));  // Key matches, predicate fails
+    EXPECT_FALSE(fsm.process(Message{3, 1}));  // Predicate passes, key differs
+    EXPECT_TRUE(fsm.process(Message{2, 1}));
+    EXPECT_EQ(fsm.getCurrentState(), "C");
+}
+
+TEST_F(FSMTest, CharacterClassGuards) {
+    FSM<char> fsm;
+    std::string word;
+
+    fsm.get_builder().from("WORD")
+        .onChars("a-z")
+        .action([&word](char c) { word += c; })
+        .to("WORD");
+    fsm.get_builder().from("WORD")
+        .onAnyExcept(' ')
+        .predicate([](char c) { return c != '!'; })
+        .to("OTHER");
+
+    fsm.setInitialState("WORD");
+    EXPECT_TRUE(fsm.process('h'));
+    EXPECT_TRUE(fsm.process('i'));
+    EXPECT_FALSE(fsm.process(' '));  // Excluded by the class
+    EXPECT_FALSE(fsm.process('!'));  // Admitted by the class, rejected by the predicate
+    EXPECT_EQ(word, "hi");
+    EXPECT_TRUE(fsm.process('X'));
+    EXPECT_EQ(fsm.getCurrentState(), "OTHER");
+}
+
+TEST_F(FSMTest, FeedResumesAcrossChunks) {
+    FSM<char> fsm;
+    std::vector<std::string> values;
+    std::string value;
+
+    fsm.get_builder().from("KEY").onChars("a-z").to("KEY");
+    fsm.get_builder().from("KEY").onChars("=").to("VALUE");
+    fsm.get_builder().from("VALUE")
+        .onAnyExcept(';')
+        .action([&value](char c) { value += c; })
+        .to("VALUE");
+    fsm.get_builder().from("VALUE")
+        .onChars(";")
+        .action([&](char) { values.push_back(value); value.clear(); })
+        .to("KEY");
+
+    EXPECT_THROW(fsm.feed("a=1;"), FSMNotInitializedError);
+    fsm.setInitialState("KEY");
+
+    // Chunk boundaries fall inside keys and values
+    for (std::string_view chunk : {"ab=he", "llo;c", "", "d=wor", "ld;"}) {
+        FeedResult result = fsm.feed(chunk);
+        EXPECT_EQ(result.consumed, chunk.size());
+        EXPECT_FALSE(result.rejected);
+    }
+    EXPECT_EQ(values, (std::vector<std::string>{"hello", "world"}));
+
+    FeedResult result = fsm.feed("ef9=x;");
+    EXPECT_EQ(result.consumed, 2u);
+    EXPECT_TRUE(result.rejected);
+    EXPECT_EQ(fsm.getCurrentState(), "KEY");
+}
+
+TEST_F(FSMTest, ProcessBatch) {
+    enum class Signal { GO, STOP, PAUSE };
+    FSM<Signal> fsm;
+    int enters = 0;
+
+    fsm.get_builder().onEnter("RUNNING", [&enters](const Signal&) { enters++; });
+    fsm.get_builder().from("IDLE").on(Signal::GO).to("RUNNING");
+    fsm.get_builder().from("RUNNING").on(Signal::STOP).to("IDLE");
+
+    std::vector<Signal> events = {Signal::GO, Signal::PAUSE, Signal::STOP, Signal::STOP, Signal::GO};
+    EXPECT_THROW(fsm.processBatch(events.begin(), events.end()), FSMNotInitializedError);
+
+    fsm.setInitialState("IDLE");
+    BatchResult result = fsm.processBatch(events.begin(), events.end());
+    EXPECT_EQ(result.transitions, 3u);
+    EXPECT_EQ(result.first_unmatched, 1u);
+    EXPECT_EQ(enters, 2);
+    EXPECT_EQ(fsm.getCurrentState(), "RUNNING");
+
+    std::vector<Signal> matching = {Signal::STOP, Signal::GO};
+    result = fsm.processBatch(matching.begin(), matching.end());
+    EXPECT_EQ(result.transitions, 2u);
+    EXPECT_EQ(result.first_unmatched, BatchResult::npos);
+
+    result = fsm.processBatch(matching.end(), matching.end());
+    EXPECT_EQ(result.transitions, 0u);
+    EXPECT_EQ(result.first_unmatched, BatchResult::npos);
+}
+
+TEST_F(FSMTest, PostedEventsDrainInOrder) {
+    FSM<int> fsm;
+    std::vector<int> seen;
+
+    fsm.get_builder().from("A").action([&seen](const int& e) { seen.push_back(e); }).to("A");
+    fsm.setQueueCapacity(4);
+
+    EXPECT_TRUE(fsm.post(1));
+    EXPECT_TRUE(fsm.post(2));
+    EXPECT_TRUE(fsm.post(3));
+    EXPECT_TRUE(fsm.post(4));
+    EXPECT_FALSE(fsm.post(5));  // Full
+    EXPECT_TRUE(seen.empty());  // Posting never processes
+
+    EXPECT_THROW(fsm.drain(), FSMNotInitializedError);
+    fsm.setInitialState("A");
+    BatchResult result = fsm.drain();
+    EXPECT_EQ(result.transitions, 4u);
+    EXPECT_EQ(result.first_unmatched, BatchResult::npos);
+    EXPECT_EQ(seen, (std::vector<int>{1, 2, 3, 4}));
+    EXPECT_EQ(fsm.drain().transitions, 0u);
+}
+
+TEST_F(FSMTest, InternalEventsRunToCompletion) {
+    FSM<std::string> fsm;
+    std::vector<std::string> log;
+    auto note = [&log](const char* what) {
+        return [&log, what](const std::string& e) { log.push_back(std::string(what) + ":" + e); };
+    };
+
+    fsm.get_builder()
+        .onEnter("READY", [&fsm](const std::string&) { fsm.postInternal("warm"); })
+        .from("READY")
+        .predicate([](const std::string& e) { return e == "warm"; })
+        .action(note("warming"))
+        .to("WARM");
+    fsm.get_builder()
+        .onExit("WARM", note("exit WARM"))
+        .from("WARM")
+        .predicate([](const std::string& e) { return e == "go"; })
+        .action([&fsm](const std::string&) {
+            fsm.postInternal("step");
+            fsm.postInternal("done");
+        })
+        .to("RUNNING");
+    fsm.get_builder()
+        .onEnter("RUNNING", note("enter RUNNING"))
+        .from("RUNNING")
+        .predicate([](const std::string& e) { return e == "step"; })
+        .action(note("step"))
+        .to("RUNNING");
+    fsm.get_builder()
+        .from("RUNNING")
+        .predicate([](const std::string& e) { return e == "done"; })
+        .to("DONE");
+
+    // The on-enter hook's event is processed before setInitialState() returns
+    fsm.setInitialState("READY");
+    EXPECT_EQ(fsm.getCurrentState(), "WARM");
+
+    // Internal events wait until the transition that posted them has finished
+    EXPECT_TRUE(fsm.process("go"));
+    EXPECT_EQ(fsm.getCurrentState(), "DONE");
+    EXPECT_EQ(log, (std::vector<std::string>{"warming:warm", "exit WARM:go", "enter RUNNING:go", "step:step"}));
+
+    fsm.setActionTiming(ActionTiming::AfterCommit);
+    EXPECT_THROW(fsm.postInternal("go"), FSMInvalidStateError);
+}
+
+TEST_F(FSMTest, AfterCommitActionsSeeTheTargetState) {
+    FSM<int> fsm;
+    std::vector<std::string> seen;
+    auto record = [&](const char* what) {
+        return [&seen, &fsm, what](const int&) {
+            seen.push_back(std::string(what) + "@" + std::string(fsm.getCurrentState()));
+        };
+    };
+
+    fsm.get_builder()
+        .onExit("A", record("exit"))
+        .onEnter("B", record("enter"))
+        .from("A")
+        .predicate([](const int& e) { return e == 1; })
+        .action(record("action"))
+        .to("B");
+    fsm.get_builder().from("B").predicate([](const int& e) { return e == 1; }).action(record("stay")).to("B");
+    fsm.setInitialState("A");
+
+    EXPECT_EQ(fsm.getActionTiming(), ActionTiming::UnderLock);
+    fsm.setActionTiming(ActionTiming::AfterCommit);
+
+    EXPECT_FALSE(fsm.process(0));
+    EXPECT_TRUE(fsm.process(1));
+    const int rest[] = {1, 0};
+    BatchResult result = fsm.processBatch(std::begin(rest), std::end(rest));
+    EXPECT_EQ(result.transitions, 1u);
+    EXPECT_EQ(result.first_unmatched, 1u);
+
+    EXPECT_EQ(seen, (std::vector<std::string>{"action@B", "exit@B", "enter@B", "stay@B"}));
+}
+
+TEST_F(FSMTest, ConcurrentPostWithSingleConsumer) {
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 5000;
+    FSM<int> fsm;
+    long long sum = 0;
+
+    fsm.get_builder().from("COUNTING").action([&sum](const int& e) { sum += e; }).to("COUNTING");
+    fsm.setInitialState("COUNTING");
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&fsm] {
+            for (int i = 1; i <= PER_PRODUCER; ++i) {
+                while (!fsm.post(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::size_t processed = 0;
+    while (processed < PRODUCERS * PER_PRODUCER) {
+        processed += fsm.drain().transitions;
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    EXPECT_EQ(sum, PRODUCERS * (static_cast<long long>(PER_PRODUCER) * (PER_PRODUCER + 1) / 2));
+}
@@ -0,0 +1,458 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "FSMgine/FSM.hpp"
+#include "FSMgine/FSMBuilder.hpp"
+#include "FSMgine/FSMDefinition.hpp"
+#include "FSMgine/FSMInstance.hpp"
+#include "FSMgine/StringInterner.hpp"
+
+using namespace fsmgine;
+
+namespace {
+
+// Per-session state for context-mode tests
+struct Tally {
+    int limit = 0;
+    int count = 0;
+    int resets = 0;
+    std::string digits;
+
+    bool belowLimit(const int&) const { return count < limit; }
+    void increment(const int&) { count++; }
+    void appendDigits(std::string_view run) { digits.append(run); }
+};
+
+} // namespace
+
+class FSMInstanceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        StringInterner::instance().clear();
+    }
+
+    // Builds a two-state toggle that counts entries into ON
+    std::shared_ptr<const FSMDefinition<int>> buildToggle() {
+        FSM<int> fsm;
+        fsm.get_builder()
+            .onEnter("ON", [this](const int&) { on_entries++; })
+            .from("OFF")
+            .predicate([](const int& e) { return e == 1; })
+            .to("ON");
+        fsm.get_builder()
+            .from("ON")
+            .predicate([](const int& e) { return e == 0; })
+            .to("OFF");
+        return fsm.compileDefinition();
+    }
+
+    std::atomic<int> on_entries{0};
+};
+
+TEST_F(FSMInstanceTest, RejectsNullDefinition) {
+    EXPECT_THROW(FSMInstance<int>(nullptr), std::invalid_argument);
+}
+
+TEST_F(FSMInstanceTest, InstancesShareDefinitionButNotState) {
+    auto definition = buildToggle();
+
+    FSMInstance<int> a(definition);
+    FSMInstance<int> b(definition);
+    EXPECT_EQ(a.getDefinition(), b.getDefinition());
+    EXPECT_EQ(definition.use_count(), 3);
+
+    a.setInitialState("OFF");
+    b.setInitialState("OFF");
+
+    EXPECT_TRUE(a.process(1));
+    EXPECT_EQ(a.getCurrentState(), "ON");
+    EXPECT_EQ(b.getCurrentState(), "OFF");
+    EXPECT_EQ(on_entries.load(), 1);
+}
+
+TEST_F(FSMInstanceTest, CopyYieldsIndependentCursor) {
+    auto definition = buildToggle();
+
+    FSMInstance<int> original(definition);
+    original.setInitialState("OFF");
+
+    FSMInstance<int> copy = original;
+    EXPECT_TRUE(copy.process(1));
+    EXPECT_EQ(copy.getCurrentState(), "ON");
+    EXPECT_EQ(original.getCurrentState(), "OFF");
+}
+
+TEST_F(FSMInstanceTest, DefinitionOutlivesSourceFSM) {
+    std::shared_ptr<const FSMDefinition<int>> definition;
+    {
+        FSM<int> fsm;
+        fsm.get_builder().from("A").to("B");
+        definition = fsm.compileDefinition();
+    }
+
+    FSMInstance<int> instance(definition);
+    instance.setInitialState("A");
+    EXPECT_TRUE(instance.process(0));
+    EXPECT_EQ(instance.getCurrentState(), "B");
+}
+
+TEST_F(FSMInstanceTest, DefinitionDrivesExternalCursor) {
+    auto definition = buildToggle();
+
+    StateId cursor = INVALID_STATE_ID;
+    definition->changeState(cursor, definition->findState("OFF"), 0);
+    EXPECT_EQ(definition->getStateName(cursor), "OFF");
+
+    EXPECT_FALSE(definition->process(cursor, 0));
+    EXPECT_TRUE(definition->process(cursor, 1));
+    EXPECT_EQ(definition->getStateName(cursor), "ON");
+    EXPECT_EQ(on_entries.load(), 1);
+}
+
+TEST_F(FSMInstanceTest, FlatLayoutKeepsEachStatesTransitions) {
+    std::vector<std::string> log;
+    FSM<int> fsm;
+    for (const char* from : {"A", "B", "C"}) {
+        std::string name = from;
+        fsm.get_builder().onExit(from, [&log, name](const int&) { log.push_back("exit " + name); });
+    }
+    // Each state gets its own guards and actions, including a guard that would match
+    // if another state's transitions leaked into the scanned range
+    fsm.get_builder().from("A").predicate([](const int& e) { return e == 1; })
+        .action([&log](const int&) { log.push_back("A1"); }).to("B");
+    fsm.get_builder().from("A").predicate([](const int& e) { return e == 2; }).to("C");
+    fsm.get_builder().from("B").predicate([](const int& e) { return e == 2; })
+        .action([&log](const int&) { log.push_back("B2"); })
+        .action([&log](const int&) { log.push_back("B2 again"); }).to("C");
+    fsm.get_builder().from("C").predicate([](const int& e) { return e == 3; })
+        .predicate([](const int&) { return true; }).to("A");
+    auto definition = fsm.compileDefinition();
+    EXPECT_EQ(definition->getStateCount(), 3u);
+    EXPECT_EQ(definition->getTransitionCount(), 4u);
+
+    FSMInstance<int> instance(definition);
+    instance.setInitialState("B");
+    EXPECT_FALSE(instance.process(1));
+    EXPECT_FALSE(instance.process(3));
+    EXPECT_TRUE(instance.process(2));
+    EXPECT_FALSE(instance.process(2));
+    EXPECT_TRUE(instance.process(3));
+    EXPECT_TRUE(instance.process(1));
+    EXPECT_EQ(instance.getCurrentState(), "B");
+    EXPECT_EQ(log, (std::vector<std::string>{"B2", "B2 again", "exit B", "exit C", "A1", "exit A"}));
+}
+
+TEST_F(FSMInstanceTest, ConcurrentInstancesOfOneDefinition) {
+    auto definition = buildToggle();
+    const int NUM_THREADS = 8;
+    const int ITERATIONS = 1000;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads.emplace_back([&definition, ITERATIONS]() {
+            FSMInstance<int> session(definition);
+            session.setInitialState("OFF");
+            for (int j = 0; j < ITERATIONS; ++j) {
+                session.process(1);
+                session.process(0);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(on_entries.load(), NUM_THREADS * ITERATIONS);
+}
+
+TEST_F(FSMInstanceTest, KeyedDispatchKeepsDefinitionOrder) {
+    FSM<int> fsm;
+    std::vector<int> taken;
+
+    // Unkeyed transitions stay eligible for every key, in definition order
+    fsm.get_builder().from("S")
+        .predicate([](const int& e) { return e < 0; })
+        .action([&taken](const int&) { taken.push_back(0); })
+        .to("S");
+    fsm.get_builder().from("S").on(5)
+        .action([&taken](const int&) { taken.push_back(1); })
+        .to("S");
+    fsm.get_builder().from("S").on(6)
+        .action([&taken](const int&) { taken.push_back(2); })
+        .to("S");
+    fsm.get_builder().from("S")
+        .action([&taken](const int&) { taken.push_back(3); })
+        .to("S");
+
+    auto instance = fsm.compile();
+    instance.setInitialState("S");
+    for (int event : {5, 6, 7, -1, 4, -5}) {
+        EXPECT_TRUE(instance.process(event));
+    }
+    EXPECT_EQ(taken, (std::vector<int>{1, 2, 3, 0, 3, 0}));
+}
+
+TEST_F(FSMInstanceTest, KeyedDispatchWithSparseKeys) {
+    struct Message { std::uint64_t id; };
+    FSM<Message> fsm;
+
+    auto builder = fsm.get_builder();
+    builder.keyedBy([](const Message& m) { return m.id; });
+    const std::uint64_t keys[] = {1, 1000, 1000000, 1000000000000ull};
+    for (std::size_t i = 0; i < 4; ++i) {
+        builder.from("HUB").on(keys[i]).to("LEAF" + std::to_string(i));
+    }
+
+    auto instance = fsm.compile();
+    for (std::size_t i = 0; i < 4; ++i) {
+        instance.setCurrentState("HUB");
+        EXPECT_TRUE(instance.process(Message{keys[i]}));
+        EXPECT_EQ(instance.getCurrentState(), "LEAF" + std::to_string(i));
+    }
+    instance.setCurrentState("HUB");
+    EXPECT_FALSE(instance.process(Message{2}));
+    EXPECT_EQ(instance.getCurrentState(), "HUB");
+}
+
+TEST_F(FSMInstanceTest, KeyedDefinitionRequiresExtractor) {
+    struct Message { int type; };
+    FSM<Message> fsm;
+    fsm.get_builder().from("A").on(1).to("B");
+    EXPECT_THROW(fsm.compileDefinition(), FSMInvalidStateError);
+}
+
+TEST_F(FSMInstanceTest, ByteTableMatchesInterpretedFSM) {
+    // A small identifier/number lexer mixing classes, predicates and unguarded transitions
+    auto build = [](FSM<char>& fsm, std::string& trace) {
+        auto builder = fsm.get_builder();
+        builder.from("START").onChars("a-zA-Z_")
+            .action([&trace](char c) { trace += 'I'; trace += c; }).to("IDENT");
+        builder.from("START").onChars("0-9")
+            .action([&trace](char c) { trace += 'N'; trace += c; }).to("NUMBER");
+        builder.from("START").onChars(" \t").to("START");
+        builder.from("IDENT").onChars("a-zA-Z0-9_")
+            .action([&trace](char c) { trace += c; }).to("IDENT");
+        builder.from("NUMBER").onChars("0-9")
+            .predicate([&trace](char) { return trace.size() < 40; })
+            .action([&trace](char c) { trace += c; }).to("NUMBER");
+        builder.from("NUMBER").onChars("0-9").to("OVERFLOW");
+        builder.from("IDENT").onAnyExcept("a-zA-Z0-9_").to("START");
+        builder.from("NUMBER").to("START");
+        builder.from("OVERFLOW").to("START");
+    };
+
+    std::string interpreted_trace;
+    std::string compiled_trace;
+    FSM<char> interpreted;
+    FSM<char> source;
+    build(interpreted, interpreted_trace);
+    build(source, compiled_trace);
+    auto compiled = source.compile();
+
+    interpreted.setInitialState("START");
+    compiled.setInitialState("START");
+
+    const std::string input = "foo bar_1 42 x9 123456789012345678901234567890123 \t!? z";
+    for (char c : input) {
+        EXPECT_EQ(interpreted.process(c), compiled.process(c)) << "at '" << c << "'";
+        EXPECT_EQ(interpreted.getCurrentState(), compiled.getCurrentState());
+    }
+    EXPECT_EQ(interpreted_trace, compiled_trace);
+}
+
+TEST_F(FSMInstanceTest, ProcessBytesSkipsSelfLoopRuns) {
+    FSM<char> fsm;
+    std::vector<std::string> values;
+    std::string current;
+    int run_calls = 0;
+
+    fsm.get_builder().from("NAME").onChars("a-z").to("NAME");
+    fsm.get_builder().from("NAME").onChars("=").to("VALUE");
+    fsm.get_builder().from("VALUE")
+        .onAnyExcept(';')
+        .spanAction([&](std::string_view run) { current.append(run); run_calls++; })
+        .to("VALUE");
+    fsm.get_builder().from("VALUE")
+        .onChars(";")
+        .action([&](char) { values.push_back(current); current.clear(); })
+        .to("NAME");
+
+    auto instance = fsm.compile();
+    instance.setInitialState("NAME");
+
+    const std::string long_value(1000, 'v');
+    const std::string input = "a=" + long_value + ";b=short;c=;";
+    EXPECT_EQ(instance.processBytes(input), input.size());
+    EXPECT_EQ(values, (std::vector<std::string>{long_value, "short", ""}));
+    EXPECT_EQ(run_calls, 2); // One call per non-empty run
+    EXPECT_EQ(instance.getCurrentState(), "NAME");
+}
+
+TEST_F(FSMInstanceTest, ProcessBytesStopsAtRejectedByte) {
+    FSM<char> fsm;
+    std::string digits;
+    fsm.get_builder().from("NUM")
+        .onChars("0-9")
+        .spanAction([&digits](std::string_view run) { digits.append(run); })
+        .to("NUM");
+
+    auto instance = fsm.compile();
+    instance.setInitialState("NUM");
+
+    EXPECT_EQ(instance.processBytes("12345x678"), 5u);
+    EXPECT_EQ(digits, "12345");
+    EXPECT_EQ(instance.processBytes(""), 0u);
+    EXPECT_EQ(instance.processBytes("9"), 1u);
+    EXPECT_EQ(digits, "123459");
+}
+
+TEST_F(FSMInstanceTest, ProcessBytesRespectsPredicatesAndActions) {
+    // Self-loops with predicates or per-byte actions are not skipped in bulk
+    FSM<char> fsm;
+    int per_byte_actions = 0;
+    int limit = 3;
+    fsm.get_builder().from("S")
+        .onChars("a")
+        .predicate([&limit](char) { return limit-- > 0; })
+        .action([&per_byte_actions](char) { per_byte_actions++; })
+        .to("S");
+
+    auto instance = fsm.compile();
+    instance.setInitialState("S");
+    EXPECT_EQ(instance.processBytes("aaaaa"), 3u);
+    EXPECT_EQ(per_byte_actions, 3);
+}
+
+TEST_F(FSMInstanceTest, SpanActionsReceiveSingleBytesFromProcess) {
+    FSM<char> fsm;
+    std::vector<std::string> spans;
+    fsm.get_builder().from("S")
+        .onAnyExcept(';')
+        .spanAction([&spans](std::string_view run) { spans.emplace_back(run); })
+        .to("S");
+
+    fsm.setInitialState("S");
+    fsm.process('x');
+
+    auto instance = fsm.compile();
+    instance.setInitialState("S");
+    instance.process('y');
+
+    EXPECT_EQ(spans, (std::vector<std::string>{"x", "y"}));
+}
+
+TEST_F(FSMInstanceTest, FeedMatchesInterpretedFeed) {
+    FSM<char> fsm;
+    std::string digits;
+    fsm.get_builder().from("NUM")
+        .onChars("0-9")
+        .spanAction([&digits](std::string_view run) { digits.append(run); })
+        .to("NUM");
+    fsm.get_builder().from("NUM").onChars(",").to("NUM");
+
+    auto instance = fsm.compile();
+    instance.setInitialState("NUM");
+
+    FeedResult first = instance.feed("12,3");
+    EXPECT_EQ(first.consumed, 4u);
+    EXPECT_FALSE(first.rejected);
+
+    FeedResult second = instance.feed("45,6x7");
+    EXPECT_EQ(second.consumed, 4u);
+    EXPECT_TRUE(second.rejected);
+    EXPECT_EQ(digits, "123456");
+
+    fsm.setInitialState("NUM");
+    digits.clear();
+    FeedResult interpreted = fsm.feed("45,6x7");
+    EXPECT_EQ(interpreted.consumed, second.consumed);
+    EXPECT_EQ(interpreted.rejected, second.rejected);
+    EXPECT_EQ(digits, "456");
+}
+
+TEST_F(FSMInstanceTest, ProcessBatchMatchesSingleEvents) {
+    auto definition = buildToggle();
+    FSMInstance<int> batched(definition);
+    FSMInstance<int> single(definition);
+    batched.setInitialState("OFF");
+    single.setInitialState("OFF");
+
+    const int events[] = {1, 1, 0, 7, 1, 0, 0};
+    std::size_t transitions = 0;
+    for (int e : events) {
+        transitions += single.process(e) ? 1 : 0;
+    }
+
+    BatchResult result = batched.processBatch(std::begin(events), std::end(events));
+    EXPECT_EQ(result.transitions, transitions);
+    EXPECT_EQ(result.first_unmatched, 1u);
+    EXPECT_EQ(batched.getCurrentStateId(), single.getCurrentStateId());
+}
+
+TEST_F(FSMInstanceTest, ContextModeSharesDefinitionAcrossContexts) {
+    static_assert(std::is_trivially_copyable_v<FSM<int, std::string_view, Tally>::Predicate>);
+    static_assert(std::is_trivially_copyable_v<FSM<int, std::string_view, Tally>::Action>);
+
+    FSM<int, std::string_view, Tally> blueprint;
+    blueprint.get_builder()
+        .onEnter("COUNTING", [](Tally& tally, const int&) { tally.resets++; })
+        .from("COUNTING")
+        .predicate([](Tally&, const int& e) { return e == 1; })
+        .predicate(memberFn<&Tally::belowLimit>)
+        .action(memberFn<&Tally::increment>)
+        .to("COUNTING");
+    blueprint.get_builder()
+        .from("COUNTING")
+        .predicate([](Tally&, const int& e) { return e == 1; })
+        .to("FULL");
+    auto definition = blueprint.compileDefinition();
+
+    Tally small;
+    small.limit = 1;
+    Tally large;
+    large.limit = 3;
+    FSMInstance<int, Tally> a(definition, small);
+    FSMInstance<int, Tally> b(definition, large);
+    a.setInitialState("COUNTING");
+    b.setInitialState("COUNTING");
+
+    const int events[] = {1, 1, 1, 1};
+    a.processBatch(std::begin(events), std::end(events));
+    for (int e : events) {
+        b.process(e);
+    }
+
+    EXPECT_EQ(small.count, 1);
+    EXPECT_EQ(large.count, 3);
+    EXPECT_EQ(small.resets, 1);
+    EXPECT_EQ(a.getCurrentState(), "FULL");
+    EXPECT_EQ(b.getCurrentState(), "FULL");
+}
+
+TEST_F(FSMInstanceTest, ContextModeSpanActionsReceiveContext) {
+    FSM<char, std::string_view, Tally> blueprint;
+    blueprint.get_builder().from("NUM")
+        .onChars("0-9")
+        .spanAction(memberFn<&Tally::appendDigits>)
+        .to("NUM");
+    blueprint.get_builder().from("NUM").onChars(",").to("NUM");
+    auto definition = blueprint.compileDefinition();
+
+    Tally first;
+    Tally second;
+    FSMInstance<char, Tally> a(definition, first);
+    FSMInstance<char, Tally> b(definition, second);
+    a.setInitialState("NUM");
+    b.setInitialState("NUM");
+
+    EXPECT_EQ(a.processBytes("12,345"), 6u);
+    FeedResult result = b.feed("6,7x8");
+    EXPECT_EQ(result.consumed, 3u);
+    EXPECT_TRUE(result.rejected);
+    EXPECT_EQ(first.digits, "12345");
+    EXPECT_EQ(second.digits, "67");
+}
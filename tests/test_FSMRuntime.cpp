@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "FSMgine/FSM.hpp"
+#include "FSMgine/FSMBuilder.hpp"
+#include "FSMgine/FSMInstance.hpp"
+#include "FSMgine/FSMRuntime.hpp"
+#include "FSMgine/StringInterner.hpp"
+
+using namespace fsmgine;
+
+namespace {
+
+// An event whose processing throws
+constexpr int POISON = 1000;
+
+// Per-actor state; only the worker running the actor touches it
+struct Session {
+    std::vector<int> received;
+    FSMRuntime<int, Session>* runtime = nullptr;
+    FSMRuntime<int, Session>::Handle next;
+
+    void check(const int& e) {
+        if (e == POISON) {
+            throw std::runtime_error("poisoned event");
+        }
+    }
+    void record(const int& e) { received.push_back(e); }
+    void forward(const int& e) {
+        if (next && e > 0) {
+            runtime->post(next, e - 1);
+        }
+    }
+};
+
+} // namespace
+
+class FSMRuntimeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        StringInterner::instance().clear();
+
+        FSM<int, std::string_view, Session> blueprint;
+        blueprint.get_builder()
+            .from("OPEN")
+            .predicate([](Session&, const int& e) { return e >= 0; })
+            .action(memberFn<&Session::check>)
+            .action(memberFn<&Session::record>)
+            .action(memberFn<&Session::forward>)
+            .to("OPEN");
+        blueprint.get_builder()
+            .from("OPEN")
+            .to("CLOSED");
+        definition = blueprint.compileDefinition();
+    }
+
+    FSMInstance<int, Session> open(Session& session) {
+        FSMInstance<int, Session> instance(definition, session);
+        instance.setInitialState("OPEN");
+        return instance;
+    }
+
+    std::shared_ptr<const FSMDefinition<int, Session>> definition;
+};
+
+TEST_F(FSMRuntimeTest, DeliversEachActorsEventsInOrder) {
+    FSMRuntime<int, Session> runtime(4);
+    std::vector<Session> sessions(100);
+    std::vector<FSMRuntime<int, Session>::Handle> handles;
+    for (auto& session : sessions) {
+        handles.push_back(runtime.spawn(open(session)));
+    }
+
+    constexpr int EVENTS = 50;
+    for (int e = 0; e < EVENTS; ++e) {
+        for (auto handle : handles) {
+            while (!runtime.post(handle, e)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    runtime.waitIdle();
+
+    for (const auto& session : sessions) {
+        ASSERT_EQ(session.received.size(), static_cast<std::size_t>(EVENTS));
+        for (int e = 0; e < EVENTS; ++e) {
+            EXPECT_EQ(session.received[e], e);
+        }
+    }
+}
+
+TEST_F(FSMRuntimeTest, ActionsCanPostToOtherActors) {
+    FSMRuntime<int, Session> runtime(2);
+    Session ping;
+    Session pong;
+    auto ping_handle = runtime.spawn(open(ping));
+    auto pong_handle = runtime.spawn(open(pong));
+    ping.runtime = &runtime;
+    ping.next = pong_handle;
+    pong.runtime = &runtime;
+    pong.next = ping_handle;
+
+    runtime.post(ping_handle, 9);
+    runtime.waitIdle();
+
+    EXPECT_EQ(ping.received, (std::vector<int>{9, 7, 5, 3, 1}));
+    EXPECT_EQ(pong.received, (std::vector<int>{8, 6, 4, 2, 0}));
+}
+
+TEST_F(FSMRuntimeTest, InstancesKeepTheirOwnState) {
+    FSMRuntime<int, Session> runtime(2);
+    Session a;
+    Session b;
+    auto a_handle = runtime.spawn(open(a));
+    auto b_handle = runtime.spawn(open(b));
+
+    runtime.post(a_handle, -1);
+    runtime.post(b_handle, 1);
+    runtime.waitIdle();
+
+    EXPECT_EQ(runtime.getInstance(a_handle).getCurrentState(), "CLOSED");
+    EXPECT_EQ(runtime.getInstance(b_handle).getCurrentState(), "OPEN");
+}
+
+TEST_F(FSMRuntimeTest, WorkerStatsCountEveryEvent) {
+    FSMRuntime<int, Session> runtime(3);
+    ASSERT_EQ(runtime.getWorkerCount(), 3u);
+
+    std::vector<Session> sessions(30);
+    std::vector<FSMRuntime<int, Session>::Handle> handles;
+    for (auto& session : sessions) {
+        handles.push_back(runtime.spawn(open(session)));
+    }
+    for (int e = 0; e < 10; ++e) {
+        for (auto handle : handles) {
+            while (!runtime.post(handle, e)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    runtime.waitIdle();
+
+    auto stats = runtime.getWorkerStats();
+    ASSERT_EQ(stats.size(), 3u);
+    std::uint64_t processed = 0;
+    for (const auto& worker : stats) {
+        processed += worker.events_processed;
+        EXPECT_EQ(worker.queue_depth, 0u);
+    }
+    EXPECT_EQ(processed, 300u);
+}
+
+TEST_F(FSMRuntimeTest, DespawnFreesInstancesOnceTheirMailIsDone) {
+    FSMRuntime<int, Session> runtime(2);
+    std::vector<Session> sessions(50);
+    std::vector<FSMRuntime<int, Session>::Handle> handles;
+    for (auto& session : sessions) {
+        handles.push_back(runtime.spawn(open(session)));
+    }
+    ASSERT_EQ(runtime.getInstanceCount(), 50u);
+
+    for (int e = 0; e < 10; ++e) {
+        for (auto handle : handles) {
+            while (!runtime.post(handle, e)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    for (auto handle : handles) {
+        runtime.despawn(handle);
+    }
+    runtime.waitIdle();
+
+    for (const auto& session : sessions) {
+        EXPECT_EQ(session.received.size(), 10u);
+    }
+    // A worker frees its instance before it counts the last event as processed
+    EXPECT_EQ(runtime.getInstanceCount(), 0u);
+
+    // Idle instances are freed on the spot
+    Session idle;
+    runtime.despawn(runtime.spawn(open(idle)));
+    EXPECT_EQ(runtime.getInstanceCount(), 0u);
+}
+
+TEST_F(FSMRuntimeTest, ThrowingInstanceFaultsAlone) {
+    FSMRuntime<int, Session> runtime(2);
+    Session bad;
+    Session good;
+    auto bad_handle = runtime.spawn(open(bad));
+    auto good_handle = runtime.spawn(open(good));
+
+    for (int e : {1, POISON, 2}) {
+        runtime.post(bad_handle, e);
+    }
+    for (int e : {1, 2, 3}) {
+        runtime.post(good_handle, e);
+    }
+    runtime.waitIdle();
+
+    EXPECT_EQ(bad.received, (std::vector<int>{1}));
+    EXPECT_EQ(good.received, (std::vector<int>{1, 2, 3}));
+    EXPECT_THROW(std::rethrow_exception(runtime.getFault(bad_handle)), std::runtime_error);
+    EXPECT_FALSE(runtime.getFault(good_handle));
+    EXPECT_FALSE(runtime.post(bad_handle, 4));
+    EXPECT_TRUE(runtime.post(good_handle, 4));
+    runtime.waitIdle();
+
+    std::uint64_t faults = 0;
+    for (const auto& worker : runtime.getWorkerStats()) {
+        faults += worker.faults;
+    }
+    EXPECT_EQ(faults, 1u);
+
+    runtime.despawn(bad_handle);
+    EXPECT_EQ(runtime.getInstanceCount(), 1u);
+}
+
+TEST_F(FSMRuntimeTest, RejectsUninitializedInstancesAndBadSizes) {
+    FSMRuntime<int, Session> runtime(1);
+    Session session;
+    EXPECT_THROW(runtime.spawn(FSMInstance<int, Session>(definition, session)), FSMNotInitializedError);
+
+    EXPECT_THROW((FSMRuntime<int, Session>(1, 0)), std::invalid_argument);
+    EXPECT_THROW((FSMRuntime<int, Session>(1, 8, 0)), std::invalid_argument);
+}
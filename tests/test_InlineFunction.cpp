@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include "FSMgine/InlineFunction.hpp"
+
+using namespace fsmgine;
+
+namespace {
+
+bool isPositive(const int& x) { return x > 0; }
+
+} // namespace
+
+TEST(InlineFunctionTest, EmptyWrappers) {
+    InlineFunction<void()> empty;
+    EXPECT_FALSE(empty);
+    EXPECT_THROW(empty(), std::bad_function_call);
+
+    InlineFunction<void()> from_nullptr = nullptr;
+    EXPECT_FALSE(from_nullptr);
+
+    bool (*null_pointer)(const int&) = nullptr;
+    InlineFunction<bool(const int&)> from_null_pointer = null_pointer;
+    EXPECT_FALSE(from_null_pointer);
+
+    std::function<void()> empty_function;
+    InlineFunction<void()> from_empty_function = empty_function;
+    EXPECT_FALSE(from_empty_function);
+}
+
+TEST(InlineFunctionTest, WrapsCallables) {
+    InlineFunction<bool(const int&)> from_pointer = &isPositive;
+    EXPECT_TRUE(from_pointer(3));
+    EXPECT_FALSE(from_pointer(-3));
+
+    int threshold = 10;
+    InlineFunction<bool(const int&)> from_lambda = [&threshold](const int& x) { return x > threshold; };
+    EXPECT_TRUE(from_lambda(11));
+    threshold = 20;
+    EXPECT_FALSE(from_lambda(11));
+
+    std::function<int(int)> twice = [](int x) { return 2 * x; };
+    InlineFunction<int(int)> from_function = twice;
+    EXPECT_EQ(from_function(21), 42);
+
+    // Like std::function, a const wrapper may hold a mutable lambda
+    const InlineFunction<int()> counter = [n = 0]() mutable { return ++n; };
+    EXPECT_EQ(counter(), 1);
+    EXPECT_EQ(counter(), 2);
+
+    // Captures up to the inline capacity are accepted
+    std::array<char, FSMGINE_INLINE_FUNCTION_CAPACITY> payload{};
+    payload[0] = 'x';
+    InlineFunction<char()> largest = [payload]() { return payload[0]; };
+    EXPECT_EQ(largest(), 'x');
+
+    // A void signature discards the callable's result, as with std::function
+    int total = 0;
+    InlineFunction<void(const int&)> discarding = [&total](const int& x) { return total += x; };
+    discarding(2);
+    discarding(3);
+    EXPECT_EQ(total, 5);
+}
+
+TEST(InlineFunctionTest, CopyMoveAndDestroy) {
+    auto resource = std::make_shared<std::string>("state");
+    {
+        InlineFunction<std::string()> original = [resource]() { return *resource; };
+        EXPECT_EQ(resource.use_count(), 2);
+
+        InlineFunction<std::string()> copy = original;
+        EXPECT_EQ(resource.use_count(), 3);
+        EXPECT_EQ(copy(), "state");
+
+        InlineFunction<std::string()> moved = std::move(original);
+        EXPECT_EQ(resource.use_count(), 3);
+        EXPECT_FALSE(original);
+        EXPECT_EQ(moved(), "state");
+
+        copy = nullptr;
+        EXPECT_EQ(resource.use_count(), 2);
+
+        copy = moved;
+        EXPECT_EQ(resource.use_count(), 3);
+        copy = std::move(moved);
+        EXPECT_EQ(resource.use_count(), 2);
+    }
+    EXPECT_EQ(resource.use_count(), 1);
+}
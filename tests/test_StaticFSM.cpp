@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "FSMgine/StaticFSM.hpp"
+
+using namespace fsmgine;
+using namespace fsmgine::static_fsm;
+
+namespace {
+
+enum class Door { CLOSED, OPEN, LOCKED };
+enum class DoorEvent { PUSH, PULL, LOCK, UNLOCK };
+
+std::vector<std::string> door_log;
+
+void logEnterOpen(const DoorEvent&) { door_log.push_back("enter OPEN"); }
+void logExitClosed(const DoorEvent&) { door_log.push_back("exit CLOSED"); }
+void logLock(const DoorEvent&) { door_log.push_back("lock"); }
+
+bool lockingAllowed = true;
+bool canLock(const DoorEvent&) { return lockingAllowed; }
+
+using DoorFSM = StaticFSM<Door, DoorEvent,
+    onEnter<Door::OPEN, Fn<&logEnterOpen>>,
+    onExit<Door::CLOSED, Fn<&logExitClosed>>,
+    from<Door::CLOSED>::on<DoorEvent::PULL>::to<Door::OPEN>,
+    from<Door::CLOSED>::on<DoorEvent::LOCK>::predicate<Fn<&canLock>>::action<Fn<&logLock>>::to<Door::LOCKED>,
+    from<Door::OPEN>::on<DoorEvent::PUSH>::to<Door::CLOSED>,
+    from<Door::LOCKED>::on<DoorEvent::UNLOCK>::to<Door::CLOSED>>;
+
+// Counts evaluations so tests can check priority order
+int first_guard_calls = 0;
+struct FirstGuard {
+    bool operator()(const int& e) const { ++first_guard_calls; return e > 0; }
+};
+struct AlwaysTrue {
+    bool operator()(const int&) const { return true; }
+};
+
+// Per-machine data reached through the context
+struct Tally {
+    int limit = 0;
+    int count = 0;
+    std::vector<std::string> log;
+
+    bool belowLimit(const int&) const { return count < limit; }
+    void add(const int& e) { count += e; }
+    void enterFull(const int&) { log.push_back("full"); }
+};
+
+bool atLimit(Tally& tally, const int&) { return tally.count >= tally.limit; }
+
+enum class Fill { EMPTY, FILLING, FULL };
+
+using TallyFSM = StaticFSM<Fill, int, context<Tally>,
+    onEnter<Fill::FULL, Member<&Tally::enterFull>>,
+    from<Fill::EMPTY>::on<1>::action<Member<&Tally::add>>::to<Fill::FILLING>,
+    from<Fill::FILLING>::predicate<Fn<&atLimit>>::to<Fill::FULL>,
+    from<Fill::FILLING>::predicate<Member<&Tally::belowLimit>>::action<Member<&Tally::add>>::to<Fill::FILLING>>;
+
+} // namespace
+
+class StaticFSMTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        door_log.clear();
+        lockingAllowed = true;
+        first_guard_calls = 0;
+    }
+};
+
+TEST_F(StaticFSMTest, RequiresInitialState) {
+    DoorFSM door;
+    EXPECT_THROW(door.getCurrentState(), FSMNotInitializedError);
+    EXPECT_THROW(door.process(DoorEvent::PULL), FSMNotInitializedError);
+}
+
+TEST_F(StaticFSMTest, ProcessesTransitionsAndActions) {
+    DoorFSM door;
+    door.setInitialState(Door::CLOSED);
+    EXPECT_EQ(door.getCurrentState(), Door::CLOSED);
+
+    EXPECT_FALSE(door.process(DoorEvent::PUSH));
+    EXPECT_TRUE(door.process(DoorEvent::PULL));
+    EXPECT_EQ(door.getCurrentState(), Door::OPEN);
+    EXPECT_TRUE(door.process(DoorEvent::PUSH));
+    EXPECT_TRUE(door.process(DoorEvent::LOCK));
+    EXPECT_EQ(door.getCurrentState(), Door::LOCKED);
+    EXPECT_FALSE(door.process(DoorEvent::PULL));
+
+    EXPECT_EQ(door_log, (std::vector<std::string>{"exit CLOSED", "enter OPEN", "lock", "exit CLOSED"}));
+}
+
+TEST_F(StaticFSMTest, GuardsBlockTransitions) {
+    DoorFSM door;
+    door.setInitialState(Door::CLOSED);
+    lockingAllowed = false;
+    EXPECT_FALSE(door.process(DoorEvent::LOCK));
+    EXPECT_EQ(door.getCurrentState(), Door::CLOSED);
+    EXPECT_TRUE(door_log.empty());
+}
+
+TEST_F(StaticFSMTest, SetCurrentStateRunsStateActions) {
+    DoorFSM door;
+    door.setInitialState(Door::CLOSED);
+    door.setCurrentState(Door::OPEN);
+    EXPECT_EQ(door.getCurrentState(), Door::OPEN);
+    EXPECT_EQ(door_log, (std::vector<std::string>{"exit CLOSED", "enter OPEN"}));
+}
+
+TEST_F(StaticFSMTest, SetCurrentStateToSameStateSkipsOnExit) {
+    DoorFSM door;
+    door.setInitialState(Door::CLOSED);
+    door.setCurrentState(Door::CLOSED);
+    EXPECT_TRUE(door_log.empty());
+
+    // On-enter still runs, matching FSM::setCurrentState()
+    door.setCurrentState(Door::OPEN);
+    door.setCurrentState(Door::OPEN);
+    EXPECT_EQ(door_log, (std::vector<std::string>{"exit CLOSED", "enter OPEN", "enter OPEN"}));
+}
+
+TEST_F(StaticFSMTest, FirstMatchingTransitionWins) {
+    enum class S { A, B, C };
+    StaticFSM<S, int,
+        from<S::A>::predicate<FirstGuard>::to<S::B>,
+        from<S::A>::predicate<AlwaysTrue>::to<S::C>,
+        from<S::B>::to<S::B>> machine;
+
+    machine.setInitialState(S::A);
+    EXPECT_TRUE(machine.process(0));
+    EXPECT_EQ(machine.getCurrentState(), S::C);
+    EXPECT_EQ(first_guard_calls, 1);
+
+    machine.setCurrentState(S::A);
+    EXPECT_TRUE(machine.process(5));
+    EXPECT_EQ(machine.getCurrentState(), S::B);
+
+    // Unguarded self-loop; states without transitions never match
+    EXPECT_TRUE(machine.process(0));
+    machine.setCurrentState(S::C);
+    EXPECT_FALSE(machine.process(0));
+}
+
+TEST_F(StaticFSMTest, EventlessMachine) {
+    enum class Phase { TICK, TOCK };
+    StaticFSM<Phase, std::monostate,
+        from<Phase::TICK>::to<Phase::TOCK>,
+        from<Phase::TOCK>::to<Phase::TICK>> clock;
+
+    clock.setInitialState(Phase::TICK);
+    EXPECT_TRUE(clock.process());
+    EXPECT_EQ(clock.getCurrentState(), Phase::TOCK);
+    EXPECT_TRUE(clock.process());
+    EXPECT_EQ(clock.getCurrentState(), Phase::TICK);
+}
+
+TEST_F(StaticFSMTest, GuardsAndActionsReachTheMachinesContext) {
+    Tally small{2, 0, {}};
+    Tally large{3, 0, {}};
+    TallyFSM a(small);
+    TallyFSM b(large);
+    a.setInitialState(Fill::EMPTY);
+    b.setInitialState(Fill::EMPTY);
+
+    EXPECT_FALSE(a.process(0)); // on<1> still matches the event alone
+    for (int i = 0; i < 3; ++i) {
+        a.process(1);
+        b.process(1);
+    }
+    EXPECT_EQ(small.count, 2);
+    EXPECT_EQ(large.count, 3);
+    EXPECT_EQ(a.getCurrentState(), Fill::FULL);
+    EXPECT_EQ(b.getCurrentState(), Fill::FILLING);
+    EXPECT_EQ(small.log, (std::vector<std::string>{"full"}));
+    EXPECT_TRUE(large.log.empty());
+
+    b.process(1);
+    EXPECT_EQ(b.getCurrentState(), Fill::FULL);
+    EXPECT_EQ(large.log, (std::vector<std::string>{"full"}));
+}
@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
 #include "FSMgine/StringInterner.hpp"
 
 using namespace fsmgine;
@@ -72,4 +75,75 @@ TEST_F(StringInternerTest, ClearFunctionality) {
     // After clear, same string should be re-interned
     EXPECT_EQ(view1, view2); // Same content
     // Note: Memory address may or may not be the same after clear
-}
\ No newline at end of file
+}
+
+TEST_F(StringInternerTest, ViewsSurviveTableGrowthAndNewChunks) {
+    auto& interner = StringInterner::instance();
+
+    std::vector<std::string_view> views;
+    for (int i = 0; i < 5000; ++i) {
+        views.push_back(interner.intern("state_" + std::to_string(i)));
+    }
+    std::string long_name(10000, 'x');
+    auto long_view = interner.intern(long_name);
+    auto empty_view = interner.intern(std::string_view());
+
+    for (int i = 0; i < 5000; ++i) {
+        auto view = interner.intern("state_" + std::to_string(i));
+        EXPECT_EQ(view, "state_" + std::to_string(i));
+        EXPECT_EQ(view.data(), views[i].data());
+    }
+    EXPECT_EQ(long_view, long_name);
+    EXPECT_EQ(interner.intern(long_name).data(), long_view.data());
+    EXPECT_TRUE(empty_view.empty());
+    EXPECT_EQ(interner.intern(std::string()).data(), empty_view.data());
+}
+
+TEST_F(StringInternerTest, ReportsMemoryUsage) {
+    auto& interner = StringInterner::instance();
+    EXPECT_EQ(interner.getMemoryUsage().strings, 0u);
+
+    interner.intern(std::string_view("idle"));
+    interner.intern(std::string_view("running"));
+    interner.intern(std::string_view("idle"));
+
+    auto usage = interner.getMemoryUsage();
+    EXPECT_EQ(usage.strings, 2u);
+    EXPECT_EQ(usage.string_bytes, sizeof("idle") + sizeof("running"));
+    EXPECT_GE(usage.arena_bytes, usage.string_bytes);
+    EXPECT_GT(usage.table_bytes, 0u);
+
+    interner.clear();
+    usage = interner.getMemoryUsage();
+    EXPECT_EQ(usage.strings, 0u);
+    EXPECT_EQ(usage.arena_bytes, 0u);
+}
+
+#ifdef FSMGINE_MULTI_THREADED
+TEST_F(StringInternerTest, ConcurrentInternKeepsOneCopy) {
+    auto& interner = StringInterner::instance();
+
+    constexpr int THREADS = 8;
+    constexpr int NAMES = 500;
+    std::vector<std::vector<std::string_view>> seen(THREADS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&interner, &seen, t] {
+            for (int i = 0; i < NAMES; ++i) {
+                // Each thread walks the names in a different order
+                seen[t].push_back(interner.intern("state_" + std::to_string((i * (t + 1)) % NAMES)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int t = 0; t < THREADS; ++t) {
+        for (int i = 0; i < NAMES; ++i) {
+            auto expected = interner.intern("state_" + std::to_string((i * (t + 1)) % NAMES));
+            EXPECT_EQ(seen[t][i].data(), expected.data());
+        }
+    }
+}
+#endif
@@ -119,3 +119,16 @@ TEST_F(TransitionTest, MoveSemantics) {
     transition2.executeActions(0);
     EXPECT_TRUE(action_called);
 }
+
+TEST_F(TransitionTest, EventKey) {
+    enum class Kind : std::uint8_t { A = 3, B = 7 };
+    TestTransition transition;
+
+    EXPECT_FALSE(transition.hasKey());
+    transition.setKey(toEventKey(Kind::B));
+    EXPECT_TRUE(transition.hasKey());
+    EXPECT_EQ(transition.getKey(), 7u);
+
+    // The key is checked by the FSM, not by predicatesPass()
+    EXPECT_TRUE(transition.predicatesPass(0));
+}